@@ -0,0 +1,142 @@
+#include "Allocations.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> count = 0;
+std::atomic<size_t> liveBytes = 0;
+std::atomic<size_t> peakBytes = 0;
+std::atomic<size_t> baseBytes = 0;
+
+// the size and the header length are kept right before the returned block
+void* allocate(size_t pSize, size_t pAlignment)
+{
+  size_t header = std::max(pAlignment, alignof(std::max_align_t));
+  size_t total = header + pSize;
+  void* block = pAlignment > alignof(std::max_align_t)
+                  ? std::aligned_alloc(pAlignment,
+                                       (total + pAlignment - 1) / pAlignment *
+                                         pAlignment)
+                  : std::malloc(total);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  size_t* fields =
+    reinterpret_cast<size_t*>(static_cast<char*>(block) + header);
+  fields[-1] = pSize;
+  fields[-2] = header;
+
+  count.fetch_add(1, std::memory_order_relaxed);
+  size_t live = liveBytes.fetch_add(pSize, std::memory_order_relaxed) + pSize;
+  size_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !peakBytes.compare_exchange_weak(
+                          peak, live, std::memory_order_relaxed)) {
+  }
+  return fields;
+}
+
+void release(void* pBlock) noexcept
+{
+  if (pBlock == nullptr) {
+    return;
+  }
+
+  size_t* fields = static_cast<size_t*>(pBlock);
+  liveBytes.fetch_sub(fields[-1], std::memory_order_relaxed);
+  std::free(static_cast<char*>(pBlock) - fields[-2]);
+}
+}
+
+void resetAllocations()
+{
+  count = 0;
+  baseBytes = liveBytes.load();
+  peakBytes = baseBytes.load();
+}
+
+Allocations allocationsSinceReset()
+{
+  return { count.load(), peakBytes.load() - baseBytes.load() };
+}
+
+void* operator new(size_t pSize)
+{
+  return allocate(pSize, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t pSize)
+{
+  return allocate(pSize, alignof(std::max_align_t));
+}
+
+void* operator new(size_t pSize, std::align_val_t pAlignment)
+{
+  return allocate(pSize, static_cast<size_t>(pAlignment));
+}
+
+void* operator new[](size_t pSize, std::align_val_t pAlignment)
+{
+  return allocate(pSize, static_cast<size_t>(pAlignment));
+}
+
+void* operator new(size_t pSize, const std::nothrow_t&) noexcept
+{
+  try {
+    return allocate(pSize, alignof(std::max_align_t));
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t pSize, const std::nothrow_t&) noexcept
+{
+  try {
+    return allocate(pSize, alignof(std::max_align_t));
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* pBlock) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete[](void* pBlock) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete(void* pBlock, size_t) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete[](void* pBlock, size_t) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete(void* pBlock, std::align_val_t) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete[](void* pBlock, std::align_val_t) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete(void* pBlock, size_t, std::align_val_t) noexcept
+{
+  release(pBlock);
+}
+
+void operator delete[](void* pBlock, size_t, std::align_val_t) noexcept
+{
+  release(pBlock);
+}
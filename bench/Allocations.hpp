@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// Every allocation of the process through the global operator new, counted by
+// the replacements in Allocations.cpp.
+struct Allocations
+{
+  size_t count;
+  // most bytes allocated at once since the last reset
+  size_t peakBytes;
+};
+
+// starts counting again from the bytes currently allocated
+void resetAllocations();
+
+Allocations allocationsSinceReset();
@@ -0,0 +1,79 @@
+#include "Corpus.hpp"
+
+std::string wideMapping(int pWidth)
+{
+  std::string yaml = "flags:\n";
+  for (int i = 0; i < pWidth; i++) {
+    yaml += "  flag" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+  }
+  return yaml;
+}
+
+std::string inventory(int pItems)
+{
+  std::string yaml = "inventory:\n";
+  for (int i = 0; i < pItems; i++) {
+    yaml += "  - item: item number " + std::to_string(i) + "\n";
+    yaml += "    quantity: " + std::to_string(i % 97) + "\n";
+    yaml += "    weight: " + std::to_string(i % 13) + ".25 # kg\n";
+    yaml += "    label: 'quoted: " + std::to_string(i) + "'\n";
+  }
+  return yaml;
+}
+
+std::string nestedConfig(int pSections)
+{
+  std::string yaml;
+  for (int i = 0; i < pSections; i++) {
+    yaml += "section" + std::to_string(i) + ":\n";
+    yaml += "  # settings of section " + std::to_string(i) + "\n";
+    yaml += "  enabled: true\n";
+    yaml += "  endpoint: https://example.com/api/" + std::to_string(i) + "\n";
+    yaml += "  limits:\n    requests: 1000\n    burst: 50\n";
+    yaml += "  tags:\n  - alpha\n  - beta\n";
+  }
+  return yaml;
+}
+
+std::string deepNesting(int pDepth, int pRepeat)
+{
+  std::string yaml;
+  for (int i = 0; i < pRepeat; i++) {
+    yaml += "chain" + std::to_string(i) + ":\n";
+    for (int level = 1; level < pDepth; level++) {
+      yaml += std::string(level * 2, ' ') + "level" + std::to_string(level) +
+              ":\n";
+      if (level % 8 == 0) {
+        yaml += std::string(level * 2 + 2, ' ') + "- item\n";
+        yaml += std::string(level * 2, ' ') + "next" + std::to_string(level) +
+                ":\n";
+      }
+    }
+    yaml += std::string(pDepth * 2, ' ') + "value: " + std::to_string(i) + "\n";
+  }
+  return yaml;
+}
+
+std::string blockScalars(int pScalars, int pLines)
+{
+  std::string yaml;
+  for (int i = 0; i < pScalars; i++) {
+    yaml += "text" + std::to_string(i) + (i % 2 ? ": >\n" : ": |\n");
+    for (int line = 0; line < pLines; line++) {
+      yaml += "  line " + std::to_string(line) +
+              " of a block scalar, long enough to look like prose\n";
+    }
+  }
+  return yaml;
+}
+
+std::string documentStream(int pDocuments)
+{
+  std::string stream;
+  for (int i = 0; i < pDocuments; i++) {
+    stream += "---\nkind: Deployment\nmetadata:\n  name: service" +
+              std::to_string(i) + "\n  labels: {tier: backend}\nspec:\n" +
+              "  replicas: 3\n  ports:\n    - 8080\n    - 8443\n";
+  }
+  return stream;
+}
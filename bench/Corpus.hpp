@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+// Generated inputs, the same for every run so that figures can be compared
+// between commits.
+
+// one mapping of pWidth scalar keys
+std::string wideMapping(int pWidth);
+
+// a long sequence of small mappings with comments and quoted scalars
+std::string inventory(int pItems);
+
+// pSections mappings of a few nested settings each
+std::string nestedConfig(int pSections);
+
+// pRepeat chains of mappings pDepth levels deep
+std::string deepNesting(int pDepth, int pRepeat);
+
+// pScalars literal and folded block scalars of pLines lines each
+std::string blockScalars(int pScalars, int pLines);
+
+// a multi-document stream of pDocuments small manifests
+std::string documentStream(int pDocuments);
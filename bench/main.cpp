@@ -0,0 +1,653 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Allocations.hpp"
+#include "Corpus.hpp"
+#include "yaml-doc/ColumnSet.hpp"
+#include "yaml-doc/Doc.hpp"
+#include "yaml-doc/DocWriter.hpp"
+#include "yaml-doc/PathSet.hpp"
+
+// keeps the optimizer from dropping the measured lookups
+static volatile size_t sink;
+
+// every figure printed, keyed section.input.metric, for --json
+static std::vector<std::pair<std::string, double>> figures;
+
+static void record(const char* pSection,
+                   std::string pInput,
+                   const char* pMetric,
+                   double pValue)
+{
+  std::replace(pInput.begin(), pInput.end(), ' ', '-');
+  figures.emplace_back(
+    std::string(pSection) + "." + pInput + "." + pMetric, pValue);
+}
+
+static bool writeJson(const char* pPath)
+{
+  FILE* out = std::strcmp(pPath, "-") == 0 ? stdout : std::fopen(pPath, "w");
+  if (out == nullptr) {
+    return false;
+  }
+
+  std::fprintf(out, "{\n");
+  for (size_t i = 0; i < figures.size(); i++) {
+    std::fprintf(out,
+                 "  \"%s\": %.10g%s\n",
+                 figures[i].first.c_str(),
+                 figures[i].second,
+                 i + 1 < figures.size() ? "," : "");
+  }
+  std::fprintf(out, "}\n");
+  return out == stdout || std::fclose(out) == 0;
+}
+
+template<typename Work>
+static double elapsedSeconds(Work pWork)
+{
+  auto start = std::chrono::steady_clock::now();
+  pWork();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double>(elapsed).count();
+}
+
+// nodes below pDoc, aliases counted once
+static size_t countNodes(const YAML::Doc& pDoc)
+{
+  size_t nodes = 1;
+  for (const YAML::Doc& node : pDoc.depthFirst()) {
+    (void)node;
+    nodes++;
+  }
+  return nodes;
+}
+
+static void benchLookupByWidth()
+{
+  std::printf("getNode latency against mapping width\n");
+  std::printf("%10s %14s %14s\n", "width", "string ns", "Path ns");
+
+  const int lookups = 200000;
+  for (int width : { 4, 16, 64, 256, 1024, 4096, 16384, 65536 }) {
+    YAML::Doc doc = YAML::Doc::parseString(wideMapping(width));
+
+    std::mt19937 random(42);
+    std::vector<std::string> paths;
+    for (int i = 0; i < 1024; i++) {
+      paths.push_back("flags.flag" + std::to_string(random() % width));
+    }
+
+    std::vector<YAML::Path> compiled;
+    for (const std::string& path : paths) {
+      compiled.emplace_back(path);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+      sink = sink + doc.getNode(paths[i % paths.size()])->getChildCount();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double stringNs =
+      std::chrono::duration<double, std::nano>(elapsed).count() / lookups;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+      sink = sink + doc.getNode(compiled[i % compiled.size()])->getChildCount();
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    double pathNs =
+      std::chrono::duration<double, std::nano>(elapsed).count() / lookups;
+
+    std::printf("%10d %14.1f %14.1f\n", width, stringNs, pathNs);
+    std::string input = "width " + std::to_string(width);
+    record("lookup-width", input, "string_ns", stringNs);
+    record("lookup-width", input, "path_ns", pathNs);
+  }
+}
+
+struct Item
+{
+  std::string item;
+  int quantity = 0;
+  double weight = 0.0;
+  std::string label;
+};
+
+YAML_DOC_FIELDS(Item, item, quantity, weight, label)
+
+static void benchStructDecode()
+{
+  const int items = 1000000;
+  YAML::Doc doc = YAML::Doc::parseString(inventory(items));
+  YAML::Doc* list = doc.getNode("inventory");
+
+  auto start = std::chrono::steady_clock::now();
+  for (YAML::Doc& node : list->children()) {
+    Item item;
+    item.item = node.getValue("item", "");
+    item.quantity = node.getValue<int>("quantity", 0);
+    item.weight = node.getValue<double>("weight", 0.0);
+    item.label = node.getValue("label", "");
+    sink = sink + item.quantity;
+  }
+  auto lookups = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (YAML::Doc& node : list->children()) {
+    sink = sink + node.getValue<Item>().quantity;
+  }
+  auto bound = std::chrono::steady_clock::now() - start;
+
+  YAML::ColumnSet columns;
+  columns.add<std::string_view>("item");
+  const YAML::Column<int>& quantity = columns.add<int>("quantity", 0);
+  columns.add<double>("weight", 0.0);
+  columns.add<std::string_view>("label");
+  start = std::chrono::steady_clock::now();
+  columns.extract(*list);
+  sink = sink + quantity[items - 1];
+  auto columnar = std::chrono::steady_clock::now() - start;
+
+  double lookupNs =
+    std::chrono::duration<double, std::nano>(lookups).count() / items;
+  double boundNs =
+    std::chrono::duration<double, std::nano>(bound).count() / items;
+  double columnNs =
+    std::chrono::duration<double, std::nano>(columnar).count() / items;
+
+  std::printf("decoding %d inventory items\n", items);
+  std::printf("%16s %14s\n", "", "ns per item");
+  std::printf("%16s %14.1f\n", "path lookups", lookupNs);
+  std::printf("%16s %14.1f\n", "YAML_DOC_FIELDS", boundNs);
+  std::printf("%16s %14.1f\n", "ColumnSet", columnNs);
+  record("decode", "inventory", "lookups_ns", lookupNs);
+  record("decode", "inventory", "fields_ns", boundNs);
+  record("decode", "inventory", "columns_ns", columnNs);
+}
+
+static void benchBatchLookup()
+{
+  const YAML::Doc doc = YAML::Doc::parseString(nestedConfig(10000));
+
+  // 200 settings of 50 sections, the way a service reads its config
+  std::mt19937 random(7);
+  std::vector<std::string> paths;
+  for (int i = 0; i < 50; i++) {
+    std::string section = "section" + std::to_string(random() % 10000);
+    for (const char* setting :
+         { "enabled", "endpoint", "limits.requests", "limits.burst" }) {
+      paths.push_back(section + "." + setting);
+    }
+  }
+  YAML::PathSet set(paths);
+  std::vector<const YAML::Doc*> found(set.size());
+
+  const int rounds = 20000;
+  double single = elapsedSeconds([&]() {
+    for (int i = 0; i < rounds; i++) {
+      for (const std::string& path : paths) {
+        const YAML::Doc* node;
+        sink = sink + doc.tryGetNode(path, node);
+      }
+    }
+  });
+  double batch = elapsedSeconds([&]() {
+    for (int i = 0; i < rounds; i++) {
+      sink = sink + doc.lookup(set, found.data());
+    }
+  });
+
+  double singleUs = single * 1e6 / rounds;
+  double batchUs = batch * 1e6 / rounds;
+  std::printf("looking up %zu settings of a config\n", paths.size());
+  std::printf("%16s %10s\n", "", "us");
+  std::printf("%16s %10.2f\n", "one by one", singleUs);
+  std::printf("%16s %10.2f\n", "PathSet", batchUs);
+  record("batch", "settings", "single_us", singleUs);
+  record("batch", "settings", "pathset_us", batchUs);
+}
+
+static double parseMBps(const std::string& pYaml,
+                        const YAML::ParseOptions& pOptions)
+{
+  const int rounds = 5;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    YAML::Doc doc = YAML::Doc::parseString(pYaml, pOptions);
+    sink = sink + doc.getChildCount();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  return pYaml.size() * rounds / seconds / (1024 * 1024);
+}
+
+static void benchParseThroughput()
+{
+  std::printf("parse throughput, block scanner against libyaml\n");
+  std::printf(
+    "%16s %10s %14s %14s\n", "input", "MB", "scanner MB/s", "libyaml MB/s");
+
+  YAML::ParseOptions scanner;
+  YAML::ParseOptions libyaml;
+  libyaml.fastScan = false;
+
+  struct Input
+  {
+    const char* name;
+    std::string yaml;
+  };
+  Input inputs[] = { { "wide mapping", wideMapping(200000) },
+                     { "inventory", inventory(100000) },
+                     { "nested config", nestedConfig(50000) } };
+
+  for (const Input& input : inputs) {
+    double scannerMBps = parseMBps(input.yaml, scanner);
+    double libyamlMBps = parseMBps(input.yaml, libyaml);
+    std::printf("%16s %10.1f %14.1f %14.1f\n",
+                input.name,
+                input.yaml.size() / (1024.0 * 1024.0),
+                scannerMBps,
+                libyamlMBps);
+    record("parse", input.name, "scanner_mbps", scannerMBps);
+    record("parse", input.name, "libyaml_mbps", libyamlMBps);
+  }
+}
+
+static void benchCorpora()
+{
+  std::printf("parse of the generated corpora, memory held by the result\n");
+  std::printf("%16s %8s %10s %12s %10s %12s\n",
+              "input",
+              "MB",
+              "MB/s",
+              "Mnodes/s",
+              "peak MB",
+              "allocations");
+
+  struct Input
+  {
+    const char* name;
+    std::string yaml;
+    bool stream;
+  };
+  Input inputs[] = { { "deep nesting", deepNesting(256, 200), false },
+                     { "wide mapping", wideMapping(200000), false },
+                     { "inventory", inventory(100000), false },
+                     { "block scalars", blockScalars(2000, 100), false },
+                     { "stream", documentStream(50000), true } };
+
+  for (const Input& input : inputs) {
+    auto parse = [&]() {
+      size_t nodes = 0;
+      if (input.stream) {
+        for (const YAML::Doc& doc : YAML::Doc::parseAllString(input.yaml)) {
+          nodes += countNodes(doc);
+        }
+      } else {
+        nodes = countNodes(YAML::Doc::parseString(input.yaml));
+      }
+      return nodes;
+    };
+
+    // one parse for memory and node counts, the documents are released once
+    // they're counted
+    resetAllocations();
+    size_t nodes = parse();
+    Allocations allocations = allocationsSinceReset();
+
+    const int rounds = 5;
+    double seconds = elapsedSeconds([&]() {
+      for (int i = 0; i < rounds; i++) {
+        sink = sink + parse();
+      }
+    });
+
+    double megabytes = input.yaml.size() / (1024.0 * 1024.0);
+    double throughput = megabytes * rounds / seconds;
+    double nodesPerSecond = nodes * rounds / seconds;
+    double peak = allocations.peakBytes / (1024.0 * 1024.0);
+    std::printf("%16s %8.1f %10.1f %12.2f %10.1f %12zu\n",
+                input.name,
+                megabytes,
+                throughput,
+                nodesPerSecond / 1e6,
+                peak,
+                allocations.count);
+    record("corpora", input.name, "mbps", throughput);
+    record("corpora", input.name, "nodes_per_s", nodesPerSecond);
+    record("corpora", input.name, "peak_mb", peak);
+    record("corpora", input.name, "allocations", allocations.count);
+  }
+}
+
+static void benchLookupLatency()
+{
+  std::printf("lookup latency in a parsed config, hits and misses\n");
+  std::printf("%24s %10s\n", "", "ns");
+
+  const int sections = 10000;
+  YAML::Doc doc = YAML::Doc::parseString(nestedConfig(sections));
+
+  std::mt19937 random(42);
+  std::vector<std::string> hits, misses;
+  for (int i = 0; i < 1024; i++) {
+    std::string section = "section" + std::to_string(random() % sections);
+    hits.push_back(section + ".limits.requests");
+    misses.push_back(i % 2 ? section + ".limits.missing"
+                           : "missing" + std::to_string(i) + ".limits");
+  }
+
+  auto measure = [&](const char* pName, int pLookups, auto pLookup) {
+    double seconds = elapsedSeconds([&]() {
+      for (int i = 0; i < pLookups; i++) {
+        pLookup(i % 1024);
+      }
+    });
+    double ns = seconds * 1e9 / pLookups;
+    std::printf("%24s %10.1f\n", pName, ns);
+    record("lookups", pName, "ns", ns);
+  };
+
+  const int lookups = 1000000;
+  measure("getNode hit", lookups, [&](int pAt) {
+    sink = sink + doc.getNode(hits[pAt])->getChildCount();
+  });
+  // a miss throws, fewer rounds
+  measure("getNode miss", lookups / 100, [&](int pAt) {
+    try {
+      sink = sink + doc.getNode(misses[pAt])->getChildCount();
+    } catch (const YAML::DocException&) {
+      sink = sink + 1;
+    }
+  });
+  measure("getValue<int> hit", lookups, [&](int pAt) {
+    sink = sink + doc.getValue<int>(hits[pAt]);
+  });
+  measure("getValue<int> miss", lookups, [&](int pAt) {
+    sink = sink + doc.getValue<int>(misses[pAt], 0);
+  });
+  measure("tryGetValue hit", lookups, [&](int pAt) {
+    int value = 0;
+    sink = sink + doc.tryGetValue(hits[pAt], &value) + value;
+  });
+  measure("tryGetValue miss", lookups, [&](int pAt) {
+    int value = 0;
+    sink = sink + doc.tryGetValue(misses[pAt], &value) + value;
+  });
+  measure("lookup miss", lookups, [&](int pAt) {
+    sink = sink + doc.lookup(misses[pAt]).getError();
+  });
+  // a mapping asked for an int
+  measure("lookupValue mismatch", lookups, [&](int pAt) {
+    std::string_view section(hits[pAt]);
+    section = section.substr(0, section.find('.'));
+    sink = sink + doc.lookupValue<int>(section).getError();
+  });
+}
+
+static void benchStreamThroughput()
+{
+  std::string stream = documentStream(200000);
+
+  std::printf("multi-document stream of %.1f MB\n",
+              stream.size() / (1024.0 * 1024.0));
+  std::printf("%10s %14s\n", "threads", "MB/s");
+
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= cores; threads *= 2) {
+    YAML::ParseOptions options;
+    options.threads = threads;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<YAML::Doc> docs = YAML::Doc::parseAllString(stream, options);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sink = sink + docs.size();
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double throughput = stream.size() / seconds / (1024 * 1024);
+    std::printf("%10u %14.1f\n", threads, throughput);
+    record("stream", std::to_string(threads) + " threads", "mbps", throughput);
+  }
+}
+
+static void benchReaderInput()
+{
+  std::string stream = documentStream(200000);
+  std::printf("multi-document stream of %.1f MB, documents dropped once "
+              "read\n",
+              stream.size() / (1024.0 * 1024.0));
+  std::printf("%16s %10s %10s\n", "", "MB/s", "peak MB");
+
+  auto measure = [&](const char* pName, auto pParse) {
+    resetAllocations();
+    auto start = std::chrono::steady_clock::now();
+    pParse();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Allocations allocations = allocationsSinceReset();
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double throughput = stream.size() / seconds / (1024 * 1024);
+    double peak = allocations.peakBytes / (1024.0 * 1024.0);
+    std::printf("%16s %10.1f %10.1f\n", pName, throughput, peak);
+    record("input", pName, "mbps", throughput);
+    record("input", pName, "peak_mb", peak);
+  };
+
+  YAML::ParseOptions serial;
+  serial.threads = 1;
+  measure("parseAllString", [&]() {
+    sink = sink + YAML::Doc::parseAllString(stream, serial).size();
+  });
+  // as a pipe would hand the stream over, 64 KiB at a time
+  measure("parseAllInput", [&]() {
+    size_t offset = 0;
+    YAML::Doc::Reader pipe = [&](char* pBuffer, size_t pSize) {
+      size_t size = std::min({ pSize, stream.size() - offset, size_t(65536) });
+      std::memcpy(pBuffer, stream.data() + offset, size);
+      offset += size;
+      return size;
+    };
+    YAML::Doc::parseAllInput(pipe, [&](YAML::Doc&& pDoc) {
+      sink = sink + pDoc.getChildCount();
+    });
+  });
+}
+
+static void benchSnapshotLoad()
+{
+  std::string yaml = inventory(200000);
+  std::string path = "bench-snapshot.ydoc";
+  YAML::Doc::parseString(yaml).saveSnapshot(path);
+
+  const int rounds = 5;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    sink = sink + YAML::Doc::parseString(yaml).getChildCount();
+  }
+  auto parsed = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; i++) {
+    sink = sink + YAML::Doc::loadSnapshot(path).getChildCount();
+  }
+  auto loaded = std::chrono::steady_clock::now() - start;
+  std::remove(path.c_str());
+
+  std::printf("inventory of %.1f MB\n", yaml.size() / (1024.0 * 1024.0));
+  double parseMs =
+    std::chrono::duration<double, std::milli>(parsed).count() / rounds;
+  double loadMs =
+    std::chrono::duration<double, std::milli>(loaded).count() / rounds;
+  std::printf("%10s %14s\n", "", "ms");
+  std::printf("%10s %14.1f\n", "parse", parseMs);
+  std::printf("%10s %14.1f\n", "snapshot", loadMs);
+  record("snapshot", "inventory", "parse_ms", parseMs);
+  record("snapshot", "inventory", "load_ms", loadMs);
+}
+
+static void benchReload()
+{
+  std::printf("one line edited in the middle of the input\n");
+  std::printf("%16s %10s %14s %14s\n", "input", "MB", "parse ms", "reload ms");
+
+  struct Input
+  {
+    const char* name;
+    std::string yaml;
+    std::string from;
+    std::string to;
+  };
+  Input inputs[] = {
+    { "inventory", inventory(200000), "quantity: 10\n", "quantity: 11\n" },
+    { "nested config", nestedConfig(100000), "burst: 50\n", "burst: 60\n" }
+  };
+
+  for (Input& input : inputs) {
+    YAML::Doc doc = YAML::Doc::parseString(input.yaml);
+    std::string edited = input.yaml;
+    size_t at = edited.find(input.from, edited.size() / 2);
+    edited.replace(at, input.from.size(), input.to);
+
+    const int rounds = 5;
+    auto measure = [&](auto pLoad) {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < rounds; i++) {
+        sink = sink + pLoad().getChildCount();
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      return std::chrono::duration<double, std::milli>(elapsed).count() /
+             rounds;
+    };
+
+    double parse = measure([&]() { return YAML::Doc::parseString(edited); });
+    double reload =
+      measure([&]() { return YAML::Doc::reloadString(doc, edited); });
+    std::printf("%16s %10.1f %14.1f %14.1f\n",
+                input.name,
+                input.yaml.size() / (1024.0 * 1024.0),
+                parse,
+                reload);
+    record("reload", input.name, "parse_ms", parse);
+    record("reload", input.name, "reload_ms", reload);
+  }
+}
+
+static void benchWriteThroughput()
+{
+  std::printf("write throughput, output bytes through a counting sink\n");
+  std::printf("%16s %10s %14s %14s\n", "input", "MB", "yaml MB/s", "tree MB/s");
+
+  struct Input
+  {
+    const char* name;
+    YAML::Doc doc;
+  };
+  Input inputs[] = {
+    { "wide mapping", YAML::Doc::parseString(wideMapping(200000)) },
+    { "inventory", YAML::Doc::parseString(inventory(100000)) },
+    { "nested config", YAML::Doc::parseString(nestedConfig(50000)) }
+  };
+
+  for (const Input& input : inputs) {
+    size_t bytes = 0;
+    YAML::DocWriter writer([&bytes](std::string_view pText) {
+      bytes += pText.size();
+    });
+
+    const int rounds = 5;
+    auto measure = [&](auto pWrite) {
+      bytes = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < rounds; i++) {
+        pWrite();
+        writer.flush();
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      double seconds = std::chrono::duration<double>(elapsed).count();
+      return bytes / seconds / (1024 * 1024);
+    };
+
+    double yaml = measure([&]() { writer.writeYaml(input.doc); });
+    double megabytes = bytes / rounds / (1024.0 * 1024.0);
+    double tree = measure([&]() { writer.writeTree(input.doc); });
+    std::printf(
+      "%16s %10.1f %14.1f %14.1f\n", input.name, megabytes, yaml, tree);
+    record("write", input.name, "yaml_mbps", yaml);
+    record("write", input.name, "tree_mbps", tree);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  struct Section
+  {
+    const char* name;
+    void (*run)();
+  };
+  const Section sections[] = { { "lookup-width", benchLookupByWidth },
+                               { "lookups", benchLookupLatency },
+                               { "batch", benchBatchLookup },
+                               { "parse", benchParseThroughput },
+                               { "corpora", benchCorpora },
+                               { "stream", benchStreamThroughput },
+                               { "input", benchReaderInput },
+                               { "decode", benchStructDecode },
+                               { "write", benchWriteThroughput },
+                               { "reload", benchReload },
+                               { "snapshot", benchSnapshotLoad } };
+
+  // yaml-doc-bench [--json FILE] [SECTION...], every section by default and
+  // "-" to write the figures to stdout
+  const char* json = nullptr;
+  std::vector<std::string> selected;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json = argv[++i];
+    } else {
+      selected.push_back(argv[i]);
+    }
+  }
+
+  for (const std::string& name : selected) {
+    if (std::none_of(std::begin(sections),
+                     std::end(sections),
+                     [&](const Section& pSection) {
+                       return name == pSection.name;
+                     })) {
+      std::fprintf(stderr, "unknown section %s, one of:", name.c_str());
+      for (const Section& section : sections) {
+        std::fprintf(stderr, " %s", section.name);
+      }
+      std::fprintf(stderr, "\n");
+      return 1;
+    }
+  }
+
+  bool first = true;
+  for (const Section& section : sections) {
+    if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), section.name) ==
+          selected.end()) {
+      continue;
+    }
+    if (!first) {
+      std::printf("\n");
+    }
+    first = false;
+    section.run();
+  }
+
+  if (json && !writeJson(json)) {
+    std::fprintf(stderr, "could not write %s\n", json);
+    return 1;
+  }
+  return 0;
+}
@@ -42,20 +42,13 @@ struct InventoryItem
   int count = 1;
 };
 
-// you can write your own conversion functions for your own types by
-// specializing the YAML::Doc::getValue<T>() template "this" is a YAML::Doc*
-template<>
-InventoryItem YAML::Doc::getValue<InventoryItem>()
-{
-  InventoryItem item;
-  item.name = getValue("name");
-  item.damage = getValue<int>("damage", 0);
-  item.defense = getValue<int>("defense", 0);
-  item.effect = getValue("effect", "none");
-  item.value = getValue<float>("value", 0.0f);
-  item.count = getValue<int>("count", 1);
-  return item;
-}
+// bind the members of your own types to the keys of a mapping with
+// YAML_DOC_FIELDS and getValue<T>() decodes them in a single pass over the
+// mapping, missing keys leave the default value of their member. You can also
+// specialize the YAML::Doc::getValue<T>() template, "this" is a YAML::Doc*:
+// template<> T YAML::Doc::getValue<T>() const works on const documents too,
+// the same without const only on mutable ones
+YAML_DOC_FIELDS(InventoryItem, name, damage, defense, effect, value, count)
 
 int main(int argc, char** argv)
 {
@@ -90,6 +83,12 @@ int main(int argc, char** argv)
     std::cout << "Our hero has equiped " << doc.getValue("equipment.sword.name")
               << std::endl; // Our hero has equiped the cheesy slicer
 
+    // paths used over and over can be split and hashed once with YAML::Path,
+    // from a string literal this happens at compile time
+    static constexpr YAML::Path swordDamage("equipment.sword.damage");
+    std::cout << "The sword deals " << doc.getValue<int>(swordDamage)
+              << " damage" << std::endl; // The sword deals -10 damage
+
     // this will throw a DocNodeException if the node doesn't exist, you can
     // either catch the exception or you can also use tryGetNode or tryGetValue
     // which will return true if the node exists and take a pointer to a
@@ -112,20 +111,20 @@ int main(int argc, char** argv)
     std::cout << "The hero's relationship with Luke is " << lukeRelationShip
               << std::endl; // The hero's relationship with Luke is terrible
 
-    // you can also iterate over the children of a node
+    // you can also iterate over the children of a node without copying them,
+    // depthFirst() and breadthFirst() walk every node below it
     YAML::Doc* inventoryNode = doc.getNode("inventory");
-    for (auto& itemNode : inventoryNode->getChildren()) {
+    for (auto& itemNode : inventoryNode->children()) {
       std::cout << "Our hero has " << itemNode.getValue<int>("count", 1) << " "
                 << itemNode.getValue("name") << std::endl;
     }
 
     // as seen above you can use generic getValue<T>() method to get a value as
     // a specific type this will throw a DocConversionException if the value
-    // can't be converted to the requested type you can write your own
-    // conversion functions for your own types by specializing the
-    // YAML::Doc::getValue<T>() template
+    // can't be converted to the requested type, types declared with
+    // YAML_DOC_FIELDS are decoded the same way
 
-    for (auto& itemNode : inventoryNode->getChildren()) {
+    for (auto& itemNode : inventoryNode->children()) {
       InventoryItem item = itemNode.getValue<InventoryItem>();
       std::cout << item.name << std::endl;
       std::cout << item.value << std::endl;
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+// FNV-1a, usable at compile time so paths can be hashed ahead of lookups
+constexpr uint64_t hashKey(std::string_view pKey)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : pKey) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Open addressing table from the hash of a child's key id to its node index,
+// built for nodes with many children. Children keep their document order in
+// the sibling list, the table only speeds up lookups by name. When a key
+// appears more than once the first child wins, like a linear scan would.
+// KeyTable uses the same table from key hashes to key ids.
+class ChildIndex
+{
+public:
+  static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+  // nodes with fewer children are scanned linearly
+  static constexpr uint32_t THRESHOLD = 16;
+
+  // the slots come from the allocator of the arena holding the table
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  ChildIndex() = default;
+  explicit ChildIndex(const allocator_type& pAllocator);
+  ChildIndex(const ChildIndex& pOther, const allocator_type& pAllocator);
+  ChildIndex(ChildIndex&& pOther, const allocator_type& pAllocator);
+  ChildIndex(const ChildIndex& pOther) = default;
+  ChildIndex(ChildIndex&& pOther) noexcept = default;
+  ChildIndex& operator=(const ChildIndex& pOther) = default;
+  ChildIndex& operator=(ChildIndex&& pOther) = default;
+
+  void reserve(uint32_t pCount);
+
+  // returns false, leaving the table untouched, if pMatches finds a child
+  // with the same key already indexed
+  template<typename Matches>
+  bool insert(uint64_t pHash, uint32_t pNode, Matches pMatches)
+  {
+    if ((count + 1) * 2 > slots.size()) {
+      grow();
+    }
+
+    uint32_t shortHash = static_cast<uint32_t>(pHash);
+    size_t mask = slots.size() - 1;
+    for (size_t i = shortHash & mask;; i = (i + 1) & mask) {
+      Slot& slot = slots[i];
+      if (slot.node == NOT_FOUND) {
+        slot = { shortHash, pNode };
+        count++;
+        return true;
+      }
+      if (slot.hash == shortHash && pMatches(slot.node)) {
+        return false;
+      }
+    }
+  }
+
+  template<typename Matches>
+  uint32_t find(uint64_t pHash, Matches pMatches) const
+  {
+    if (slots.empty()) {
+      return NOT_FOUND;
+    }
+
+    uint32_t shortHash = static_cast<uint32_t>(pHash);
+    size_t mask = slots.size() - 1;
+    for (size_t i = shortHash & mask;; i = (i + 1) & mask) {
+      const Slot& slot = slots[i];
+      if (slot.node == NOT_FOUND) {
+        return NOT_FOUND;
+      }
+      if (slot.hash == shortHash && pMatches(slot.node)) {
+        return slot.node;
+      }
+    }
+  }
+
+  inline uint32_t size() const { return count; }
+
+  // for a copy of the table in an arena where the children moved
+  template<typename Renumber>
+  void renumber(Renumber pRenumber)
+  {
+    for (Slot& slot : slots) {
+      if (slot.node != NOT_FOUND) {
+        slot.node = pRenumber(slot.node);
+      }
+    }
+  }
+
+private:
+  struct Slot
+  {
+    uint32_t hash;
+    uint32_t node;
+  };
+
+  void grow();
+
+private:
+  std::pmr::vector<Slot> slots;
+  uint32_t count = 0;
+};
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Doc.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace YAML {
+
+// What the columns of a ColumnSet share whatever their type
+class ColumnBase
+{
+public:
+  virtual ~ColumnBase() = default;
+
+  inline size_t size() const { return rows; }
+
+  inline bool isValid(size_t pRow) const
+  {
+    return (validity[pRow / 64] >> (pRow % 64)) & 1;
+  }
+
+  // bit pRow % 64 of word pRow / 64 is set for the valid rows
+  inline const std::vector<uint64_t>& getValidity() const { return validity; }
+
+  size_t countValid() const;
+
+  inline std::string_view getField() const { return field; }
+
+protected:
+  friend class ColumnSet;
+
+  explicit ColumnBase(std::string_view pField)
+    : field(pField)
+  {
+  }
+
+  // empties the column and makes room for pRows rows
+  virtual void clear(size_t pRows) = 0;
+
+  // converts the next pCount rows, pNodes holding the field of each element
+  // or nullptr
+  virtual void append(const Doc* const* pNodes, size_t pCount) = 0;
+
+  void grow(size_t pCount);
+
+  inline void setValid(size_t pRow)
+  {
+    validity[pRow / 64] |= uint64_t(1) << (pRow % 64);
+  }
+
+protected:
+  std::string field;
+  std::vector<uint64_t> validity;
+  size_t rows = 0;
+};
+
+// The values of one field across the elements of a sequence, one row per
+// element. Rows whose element lacks the field, or holds something that
+// doesn't convert to T, get the default of the column and a clear bit in
+// the validity bitmap. std::string_view columns refer to the document, bool
+// columns keep a byte per row so that their values stay contiguous too.
+template<typename T>
+class Column : public ColumnBase
+{
+public:
+  using Stored = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+  using Reference = std::conditional_t<std::is_same_v<T, bool>, bool, const T&>;
+
+  Column(std::string_view pField, T pDefault)
+    : ColumnBase(pField)
+    , defaultValue(std::move(pDefault))
+  {
+  }
+
+  inline const std::vector<Stored>& getValues() const { return values; }
+
+  inline Reference operator[](size_t pRow) const { return values[pRow]; }
+
+protected:
+  void clear(size_t pRows) override
+  {
+    values.clear();
+    values.reserve(pRows);
+    validity.clear();
+    validity.reserve((pRows + 63) / 64);
+    rows = 0;
+  }
+
+  void append(const Doc* const* pNodes, size_t pCount) override
+  {
+    size_t start = rows;
+    grow(pCount);
+    values.resize(rows, defaultValue);
+
+    for (size_t i = 0; i < pCount; i++) {
+      if (pNodes[i] == nullptr) {
+        continue;
+      }
+
+      DocResult<T> value = pNodes[i]->convert<T>();
+      if (value) {
+        values[start + i] = std::move(*value);
+        setValid(start + i);
+      }
+    }
+  }
+
+private:
+  std::vector<Stored> values;
+  T defaultValue;
+};
+
+// Pulls fields out of every element of a sequence of mappings into typed
+// columns, struct of arrays rather than a struct per element:
+//
+//   YAML::ColumnSet columns;
+//   const YAML::Column<int>& damage = columns.add<int>("damage", 0);
+//   const YAML::Column<std::string_view>& names =
+//     columns.add<std::string_view>("item");
+//   columns.extract(*doc.getNode("inventory"));
+//   for (size_t i = 0; i < columns.size(); i++) {
+//     total += damage[i];
+//   }
+//
+// Each element is scanned once for all the fields, whose names are looked up
+// in the document's key table once per extract(). Values are then converted
+// a column at a time, a block of rows after the other. Fields may be dotted
+// paths below each element, which are looked up element by element instead.
+class ColumnSet
+{
+public:
+  // rows converted a column at a time
+  static constexpr size_t BLOCK = 256;
+
+  // the column stays valid and at the same address as long as the set
+  template<typename T>
+  const Column<T>& add(std::string_view pField, T pDefault = T())
+  {
+    auto column = std::make_unique<Column<T>>(pField, std::move(pDefault));
+    Column<T>& added = *column;
+    columns.push_back(std::move(column));
+    return added;
+  }
+
+  // fills every column with one row per child of pSequence, replacing what
+  // a previous call extracted
+  void extract(const Doc& pSequence);
+
+  inline size_t size() const { return rows; }
+
+private:
+  std::vector<std::unique_ptr<ColumnBase>> columns;
+  size_t rows = 0;
+};
+
+}
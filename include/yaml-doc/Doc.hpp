@@ -1,15 +1,27 @@
 #pragma once
 
+#include "DocArena.hpp"
+#include "DocChanges.hpp"
+#include "DocFields.hpp"
+#include "DocIterators.hpp"
+#include "DocResult.hpp"
+#include "DocVisitor.hpp"
+#include "ParseOptions.hpp"
+#include "Path.hpp"
+#include "PathSet.hpp"
+#include "Scalar.hpp"
+#include "Selection.hpp"
 #include "exceptions/DocConversionException.hpp"
 #include "exceptions/DocException.hpp"
-#include <sstream>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
-typedef struct yaml_parser_s yaml_parser_t;
-typedef struct yaml_event_s yaml_event_t;
-
 namespace YAML {
 
 template<typename T>
@@ -18,7 +30,7 @@ concept Numeric = std::is_arithmetic_v<T>;
 class Doc
 {
 public:
-  enum Type
+  enum Type : uint8_t
   {
     NONE,
     ROOT,
@@ -27,14 +39,98 @@ public:
     SEQUENCE
   };
 
+  // fills up to pSize bytes of pBuffer with the next bytes of the input and
+  // returns how many, 0 once the input is exhausted
+  using Reader = std::function<size_t(char* pBuffer, size_t pSize)>;
+  // receives each document of a stream as soon as it's complete
+  using Handler = std::function<void(Doc&& pDoc)>;
+
+  // files are read into the document, which doesn't depend on them
+  // afterwards, unless ParseOptions::mapFile asks for a mapping
   static Doc parseFile(const std::string& pPath);
   static Doc parseString(const std::string& pString);
+  static Doc parseString(std::string&& pString);
+  static Doc parseFile(const std::string& pPath, const ParseOptions& pOptions);
+  static Doc parseString(const std::string& pString,
+                         const ParseOptions& pOptions);
+  static Doc parseFile(const std::string& pPath,
+                       std::pmr::memory_resource* pMemory);
+  static Doc parseString(const std::string& pString,
+                         std::pmr::memory_resource* pMemory);
+
+  // one document per "---" section of the stream, in stream order. Large
+  // streams are split at document markers and parsed on several threads.
+  // Files are read or mapped as in parseFile().
+  static std::vector<Doc> parseAllFile(const std::string& pPath);
+  static std::vector<Doc> parseAllFile(const std::string& pPath,
+                                       const ParseOptions& pOptions);
+  static std::vector<Doc> parseAllString(const std::string& pString);
+  static std::vector<Doc> parseAllString(std::string&& pString);
+  static std::vector<Doc> parseAllString(const std::string& pString,
+                                         const ParseOptions& pOptions);
+
+  // build only the subtrees in pSelection, their keys and values are copied
+  // so the input isn't kept around
+  static Doc parseFile(const std::string& pPath, const Selection& pSelection);
+  static Doc parseString(std::string_view pString,
+                         const Selection& pSelection);
+
+  // stream the content to pVisitor without building any node, files are read
+  // incrementally so memory stays flat whatever their size
+  static void parseFile(const std::string& pPath, DocVisitor& pVisitor);
+  static void parseString(std::string_view pString, DocVisitor& pVisitor);
+
+  // input pulled a buffer at a time, from a pipe, a socket or a decompressor,
+  // so memory stays flat whatever its size. Exceptions thrown by pRead are
+  // passed on.
+  static void parseInput(const Reader& pRead, DocVisitor& pVisitor);
+  static void parseInput(std::istream& pInput, DocVisitor& pVisitor);
+
+  // each document of such an input is built then handed to pOnDocument, only
+  // the documents it keeps stay in memory. Every scalar is copied into its
+  // document. Only ParseOptions::memory is used.
+  static void parseAllInput(const Reader& pRead,
+                            const Handler& pOnDocument,
+                            const ParseOptions& pOptions = ParseOptions());
+  static void parseAllInput(std::istream& pInput,
+                            const Handler& pOnDocument,
+                            const ParseOptions& pOptions = ParseOptions());
+
+  // compact binary image of the document, loadSnapshot() maps it back without
+  // parsing and its names and values stay views into the mapping. See
+  // ParseOptions::snapshotCache to have parseFile() keep them for you.
+  void saveSnapshot(const std::string& pPath) const;
+  static Doc loadSnapshot(const std::string& pPath);
+
+  // parse the new content of pPrevious, a document parsed from a string or a
+  // file. Only the entries of the innermost block mapping or sequence around
+  // the edited bytes are parsed again, the rest is copied from pPrevious
+  // without reading its text.
+  // Edits this can't isolate (anchors, merge keys, flow or root sequence
+  // documents, trees modified after parsing) get a full parse. pChanges,
+  // when given, receives the paths that differ from pPrevious. The file is
+  // read, not mapped, but a pPrevious parsed with ParseOptions::mapFile
+  // still needs its file replaced (written aside then renamed) rather than
+  // rewritten in place.
+  static Doc reloadString(const Doc& pPrevious,
+                          std::string pString,
+                          DocChanges* pChanges = nullptr);
+  static Doc reloadFile(const Doc& pPrevious,
+                        const std::string& pPath,
+                        DocChanges* pChanges = nullptr);
 
   Doc();
-  Doc(Doc* pParent);
+  // an empty document allocating from pMemory, which must outlive it
+  explicit Doc(std::pmr::memory_resource* pMemory);
+  // copies allocate from the resource of pOther, assignments keep the one of
+  // the document assigned to and moves between resources copy. Copies expand
+  // aliases, moves that have to copy (a node of another document, another
+  // resource) keep them shared: only running out of memory can fail them.
   Doc(const Doc& pOther);
   Doc& operator=(const Doc& pOther);
   Doc(Doc&& other) noexcept;
+  Doc& operator=(Doc&& pOther) noexcept;
+  ~Doc();
 
   Doc* addChild(Doc pChild);
   Doc* createChild();
@@ -43,35 +139,206 @@ public:
   std::string toString() const;
   std::string toString(int pDepth) const;
 
+  // block style YAML that parses back to the same tree, see DocWriter to
+  // write it to any other sink
+  std::string toYaml() const;
+  void writeYaml(std::ostream& pOut) const;
+
   inline Doc::Type getType() const { return type; }
 
-  inline std::string getName() const { return name; }
+  inline std::string getName() const { return std::string(getNameView()); }
+
+  // views stay valid as long as the document they belong to
+  inline std::string_view getNameView() const
+  {
+    return arena ? arena->getKey(key) : std::string_view();
+  }
+
+  using ChildRange = BasicChildRange<Doc>;
+  using ConstChildRange = BasicChildRange<const Doc>;
+  using DepthFirstRange = BasicTraversal<BasicDepthFirstIterator<Doc>, Doc>;
+  using ConstDepthFirstRange =
+    BasicTraversal<BasicDepthFirstIterator<const Doc>, const Doc>;
+  using BreadthFirstRange =
+    BasicTraversal<BasicBreadthFirstIterator<Doc>, Doc>;
+  using ConstBreadthFirstRange =
+    BasicTraversal<BasicBreadthFirstIterator<const Doc>, const Doc>;
+
+  // copies every child with its subtree, prefer children() to iterate
+  std::vector<Doc> getChildren() const;
+
+  inline ChildRange children() { return ChildRange(this); }
+
+  inline ConstChildRange children() const { return ConstChildRange(this); }
+
+  // every node below this one, depth first (preorder) or level by level
+  inline DepthFirstRange depthFirst() { return DepthFirstRange(this); }
+
+  inline ConstDepthFirstRange depthFirst() const
+  {
+    return ConstDepthFirstRange(this);
+  }
+
+  inline BreadthFirstRange breadthFirst() { return BreadthFirstRange(this); }
+
+  inline ConstBreadthFirstRange breadthFirst() const
+  {
+    return ConstBreadthFirstRange(this);
+  }
+
+  // aliases share the content of their anchored node: its value, and
+  // children that are reached through both nodes but belong to the anchored
+  // one. Copying or printing an alias expands the shared subtree, which fails
+  // once more than MAX_ALIAS_EXPANSION nodes would be created.
+  inline bool isAlias() const { return alias != DocArena::NO_NODE; }
+
+  static constexpr size_t MAX_ALIAS_EXPANSION = 1 << 20;
+
+  inline size_t getChildCount() const { return content()->childCount; }
 
-  inline std::vector<Doc> getChildren() const { return children; }
+  // a const node only leads to const nodes, so a FrozenDoc stays read only
+  inline Doc* getFirstChild() { return firstChildNode(); }
 
-  inline Doc* getParent() const { return parent; }
+  inline const Doc* getFirstChild() const { return firstChildNode(); }
+
+  inline Doc* getNextSibling() { return nextSiblingNode(); }
+
+  inline const Doc* getNextSibling() const { return nextSiblingNode(); }
+
+  inline Doc* getParent() { return parentNode(); }
+
+  inline const Doc* getParent() const { return parentNode(); }
 
   Doc* getNode(const std::string& pPath);
+  Doc* getNode(const Path& pPath);
 
   bool tryGetNode(const std::string& pPath, Doc*& pOut);
+  bool tryGetNode(const Path& pPath, Doc*& pOut);
+
+  // const lookups never modify the tree, wide nodes that weren't indexed yet
+  // are scanned instead. They are safe to call from several threads at once,
+  // see FrozenDoc to have every index built beforehand.
+  const Doc* getNode(const std::string& pPath) const;
+  const Doc* getNode(const Path& pPath) const;
+
+  bool tryGetNode(const std::string& pPath, const Doc*& pOut) const;
+  bool tryGetNode(const Path& pPath, const Doc*& pOut) const;
+
+  // what getNode() and getValue<T>() are built on, a miss or a failed
+  // conversion is returned rather than thrown. See DocResult.hpp.
+  DocResult<Doc*> lookup(std::string_view pPath);
+  DocResult<Doc*> lookup(const Path& pPath);
+  DocResult<const Doc*> lookup(std::string_view pPath) const;
+  DocResult<const Doc*> lookup(const Path& pPath) const;
+
+  // finds every path of pPaths in one walk below this node, a segment shared
+  // by several paths is looked up once. pOut gets pPaths.size() nodes in the
+  // order the paths were added, nullptr for the missing ones. Returns how
+  // many were found.
+  size_t lookup(const PathSet& pPaths, Doc** pOut);
+  size_t lookup(const PathSet& pPaths, const Doc** pOut) const;
+
+  // numbers, bool, std::string, std::string_view, YAML_DOC_FIELDS structs
+  // and vectors of those. Other types go through their getValue<T>()
+  // specialization, a DocException it throws becomes CONVERSION_FAILED.
+  template<typename T>
+  DocResult<T> convert() const
+  {
+    if constexpr (!decodable<T>()) {
+      return specialized<T>(*this);
+    } else {
+      T returnValue{};
+      DocError::Code error = decode(returnValue);
+      if (error != DocError::NONE) {
+        return error;
+      }
+      return returnValue;
+    }
+  }
+
+  // mutable nodes can use a mutable getValue<T>() specialization
+  template<typename T>
+  DocResult<T> convert()
+  {
+    if constexpr (!decodable<T>()) {
+      return specialized<T>(*this);
+    } else {
+      return static_cast<const Doc&>(*this).convert<T>();
+    }
+  }
 
-  inline std::string getValue() { return value; }
+  template<typename T>
+  DocResult<T> lookupValue(std::string_view pPath)
+  {
+    Doc* node = findNode(pPath);
+    return node ? node->convert<T>() : DocResult<T>(DocError::NOT_FOUND);
+  }
 
   template<typename T>
-  T getValue();
+  DocResult<T> lookupValue(const Path& pPath)
+  {
+    Doc* node = findNode(pPath);
+    return node ? node->convert<T>() : DocResult<T>(DocError::NOT_FOUND);
+  }
 
-  template<Numeric T>
+  template<typename T>
+  DocResult<T> lookupValue(std::string_view pPath) const
+  {
+    const Doc* node = lookupNode(pPath);
+    return node ? node->convert<T>() : DocResult<T>(DocError::NOT_FOUND);
+  }
+
+  template<typename T>
+  DocResult<T> lookupValue(const Path& pPath) const
+  {
+    const Doc* node = lookupNode(pPath);
+    return node ? node->convert<T>() : DocResult<T>(DocError::NOT_FOUND);
+  }
+
+  // counts the path lookups made anywhere in this document into pStats,
+  // until called again with nullptr. pStats must outlive that, a lookup only
+  // tests for it when off. Has no effect on an empty document.
+  void setLookupStats(LookupStats* pStats) const;
+
+  // where the nodes and strings of this document come from
+  std::pmr::memory_resource* getMemoryResource() const;
+
+  inline std::string getValue() const { return std::string(value); }
+
+  inline std::string_view getValueView() const { return value; }
+
+  // how the scalar resolved when parsed, Scalar::STRING for quoted scalars
+  // and nodes that aren't scalars
+  inline Scalar::Kind getScalarKind() const { return kind; }
+
+  // the customization point for your own types, specialize either:
+  //
+  //   template<> Item YAML::Doc::getValue<Item>() const { ... }
+  //   template<> Item YAML::Doc::getValue<Item>() { ... }
+  //
+  // a const specialization serves const and mutable nodes alike, a mutable
+  // one only mutable nodes. Without a specialization mutable nodes use the
+  // const overloads.
+  template<typename T>
   T getValue()
   {
-    T returnValue;
-    std::istringstream stream(value);
-    stream >> returnValue;
-    if (stream.fail() || !stream.eof()) {
-      throw DocConversionException("Could not convert " + name + " to " +
-                                   typeid(T).name());
-    }
+    return static_cast<const Doc&>(*this).getValue<T>();
+  }
+
+  template<typename T>
+  T getValue() const;
+
+  template<Numeric T>
+  T getValue() const
+  {
+    return valueOrThrow(convert<T>());
+  }
 
-    return returnValue;
+  // structs declared with YAML_DOC_FIELDS, see DocFields.hpp
+  template<Bound T>
+  T getValue() const
+  {
+    return valueOrThrow(convert<T>());
   }
 
   template<typename T>
@@ -80,14 +347,7 @@ public:
   template<Numeric T>
   T getValueOr(T pDefault)
   {
-    T returnValue;
-    std::istringstream stream(value);
-    stream >> returnValue;
-    if (stream.fail() || !stream.eof()) {
-      return pDefault;
-    }
-
-    return returnValue;
+    return convert<T>().getValueOr(pDefault);
   }
 
   template<typename T>
@@ -97,6 +357,13 @@ public:
     return node->getValue<T>();
   }
 
+  template<typename T>
+  T getValue(const Path& pPath)
+  {
+    Doc* node = getNode(pPath);
+    return node->getValue<T>();
+  }
+
   template<typename T>
   T getValue(const std::string& pPath, T pDefault)
   {
@@ -107,70 +374,413 @@ public:
     return pDefault;
   }
 
+  template<typename T>
+  T getValue(const Path& pPath, T pDefault)
+  {
+    Doc* node;
+    if (tryGetNode(pPath, node)) {
+      return node->getValueOr<T>(pDefault);
+    }
+    return pDefault;
+  }
+
+  template<typename T>
+  T getValue(const std::string& pPath) const
+  {
+    return getNode(pPath)->getValue<T>();
+  }
+
+  template<typename T>
+  T getValue(const Path& pPath) const
+  {
+    return getNode(pPath)->getValue<T>();
+  }
+
+  template<Numeric T>
+  T getValue(const std::string& pPath, T pDefault) const
+  {
+    return lookupValue<T>(pPath).getValueOr(pDefault);
+  }
+
+  template<Numeric T>
+  T getValue(const Path& pPath, T pDefault) const
+  {
+    return lookupValue<T>(pPath).getValueOr(pDefault);
+  }
+
   std::string getValue(const std::string& pPath);
+  std::string getValue(const Path& pPath);
 
   std::string getValue(const std::string& pPath, const std::string& pDefault);
+  std::string getValue(const Path& pPath, const std::string& pDefault);
+
+  std::string getValue(const std::string& pPath, const char* pDefault);
+  std::string getValue(const Path& pPath, const char* pDefault);
+
+  std::string getValue(const std::string& pPath) const;
+  std::string getValue(const Path& pPath) const;
+
+  std::string getValue(const std::string& pPath,
+                       std::string_view pDefault) const;
+  std::string getValue(const Path& pPath, std::string_view pDefault) const;
 
   bool tryGetValue(const std::string& pPath,
                    std::string* pOut,
                    const std::string& pDefaultValue);
+  bool tryGetValue(const Path& pPath,
+                   std::string* pOut,
+                   const std::string& pDefaultValue);
 
   bool tryGetValue(const std::string& pPath, std::string* pOut);
+  bool tryGetValue(const Path& pPath, std::string* pOut);
 
+  // false when the node is missing or doesn't convert to T, pOut is then
+  // left alone or given pDefaultValue
   template<typename T>
   bool tryGetValue(const std::string& pPath, T* pOut)
   {
-    Doc* node;
-    if (tryGetNode(pPath, node)) {
-      if (pOut != nullptr) {
-        *pOut = node->getValue<T>();
-        return true;
-      }
-    }
+    return pOut != nullptr && store(lookupValue<T>(pPath), *pOut);
+  }
 
-    return false;
+  template<typename T>
+  bool tryGetValue(const Path& pPath, T* pOut)
+  {
+    return pOut != nullptr && store(lookupValue<T>(pPath), *pOut);
   }
 
   template<typename T>
   bool tryGetValue(const std::string& pPath, T* pOut, T pDefaultValue)
   {
-    Doc* node;
-    if (tryGetNode(pPath, node)) {
-      if (pOut != nullptr) {
-        *pOut = node->getValue<T>();
-        return true;
-      }
+    if (pOut == nullptr) {
+      return false;
     }
 
-    if (pOut != nullptr) {
-      *pOut = pDefaultValue;
+    if (store(lookupValue<T>(pPath), *pOut)) {
+      return true;
     }
-
+    *pOut = std::move(pDefaultValue);
     return false;
   }
 
   template<typename T>
-  bool tryGetValue(T* pOut)
+  bool tryGetValue(const Path& pPath, T* pOut, T pDefaultValue)
   {
-    try {
-      *pOut = this->getValue<T>();
+    if (pOut == nullptr) {
+      return false;
+    }
+
+    if (store(lookupValue<T>(pPath), *pOut)) {
       return true;
-    } catch (DocException exception) {
     }
+    *pOut = std::move(pDefaultValue);
     return false;
   }
 
+  template<typename T>
+  bool tryGetValue(T* pOut)
+  {
+    return store(convert<T>(), *pOut);
+  }
+
 private:
-  static void processYamlEvents(yaml_parser_t& pParser,
-                                yaml_event_t& pEvent,
-                                Doc& pDoc);
+  friend class BlockScanner;
+  friend class ColumnSet;
+  friend class DocBuilder;
+  friend class DocReloader;
+  friend class DocWriter;
+  friend class FrozenDoc;
+  friend class Snapshot;
+  friend class StreamBuilder;
+
+  enum Flags : uint8_t
+  {
+    TERMINATED_VALUE = 1
+  };
+
+  static Doc parseBuffer(std::shared_ptr<const void> pOwner,
+                         std::string_view pBytes,
+                         const ParseOptions& pOptions,
+                         const Selection* pSelection = nullptr);
+
+  static std::vector<Doc> parseStream(std::shared_ptr<const void> pOwner,
+                                      std::string_view pBytes,
+                                      const ParseOptions& pOptions);
+
+  // reads what's left of pInput
+  static Reader streamReader(std::istream& pInput);
+
+  static void parseDocuments(const std::shared_ptr<const void>& pOwner,
+                             std::string_view pBytes,
+                             const ParseOptions& pOptions,
+                             std::vector<Doc>& pOut);
+
+  // names the root and retains pBytes unless pOwner is null
+  void initRoot(std::shared_ptr<const void> pOwner,
+                std::string_view pBytes,
+                std::pmr::memory_resource* pMemory);
+
+  // pMemory only matters to the call creating the arena
+  DocArena* ensureArena(std::pmr::memory_resource* pMemory = nullptr);
+
+  void setScalar(std::string_view pValue, bool pPlain, std::string_view pTag);
+
+  template<Numeric T>
+  bool toNumber(T& pOut) const
+  {
+    if constexpr (std::is_same_v<T, bool>) {
+      return toBool(pOut);
+    } else {
+      switch (kind) {
+        case Scalar::INTEGER:
+          return Scalar::fromInteger(number.integer, pOut);
+        case Scalar::FLOAT:
+          return Scalar::fromFloat(number.real, pOut);
+        case Scalar::STRING:
+          return Scalar::parseNumber(value, pOut);
+        default:
+          return false;
+      }
+    }
+  }
+
+  bool toBool(bool& pOut) const;
+
+  template<typename T>
+  static bool store(DocResult<T>&& pResult, T& pOut)
+  {
+    if (!pResult) {
+      return false;
+    }
+    pOut = std::move(*pResult);
+    return true;
+  }
+
+  template<typename T>
+  T valueOrThrow(DocResult<T>&& pResult) const
+  {
+    if (!pResult) {
+      throw DocConversionException("Could not convert " + getName() + " to " +
+                                   typeid(T).name());
+    }
+    return std::move(*pResult);
+  }
+
+  // a mapping or sequence, that a scalar conversion can't read
+  inline bool isContainer() const
+  {
+    return type == MAPPING || type == SEQUENCE || getChildCount() != 0;
+  }
+
+  // a scalar with a value, that a struct or vector can't be read from
+  inline bool isFilledScalar() const
+  {
+    return type == SCALAR && kind != Scalar::NULL_VALUE && getChildCount() == 0;
+  }
+
+  // adds the shape and storage of the document to pStats
+  void collectStats(ParseStats& pStats) const;
+
+  inline LookupStats* lookupStats() const
+  {
+    return arena ? arena->getLookupStats() : nullptr;
+  }
+
+  template<typename T>
+  static constexpr bool decodable()
+  {
+    return requires(const Doc& pNode, T& pOut) { pNode.decode(pOut); };
+  }
+
+  template<typename T, typename Node>
+  static DocResult<T> specialized(Node& pNode)
+  {
+    try {
+      return pNode.template getValue<T>();
+    } catch (const DocException&) {
+      return DocError::CONVERSION_FAILED;
+    }
+  }
+
+  // the decode() overloads stop at the first node that doesn't convert
+  template<Bound T>
+  DocError::Code decode(T& pOut) const
+  {
+    if (isFilledScalar()) {
+      return DocError::TYPE_MISMATCH;
+    }
+
+    // one pass over the children, each key is matched against the fields
+    // by hash first
+    DocError::Code error = DocError::NONE;
+    for (const Doc& child : children()) {
+      uint32_t hash = arena->getKeys().getHash(child.key);
+      std::string_view name = child.getNameView();
+      std::apply(
+        [&](const auto&... pField) {
+          (void)((static_cast<uint32_t>(pField.hash) == hash &&
+                  pField.key == name &&
+                  (error = child.decode(pOut.*(pField.member)), true)) ||
+                 ...);
+        },
+        DocFields<T>::fields);
+      if (error != DocError::NONE) {
+        return error;
+      }
+    }
+    return DocError::NONE;
+  }
+
+  template<typename T>
+  DocError::Code decode(std::vector<T>& pOut) const
+  {
+    if (isFilledScalar()) {
+      return DocError::TYPE_MISMATCH;
+    }
+
+    pOut.clear();
+    pOut.reserve(getChildCount());
+    for (const Doc& item : children()) {
+      T element{};
+      DocError::Code error = item.decode(element);
+      if (error != DocError::NONE) {
+        return error;
+      }
+      pOut.push_back(std::move(element));
+    }
+    return DocError::NONE;
+  }
+
+  template<Numeric T>
+  DocError::Code decode(T& pOut) const
+  {
+    if (isContainer()) {
+      return DocError::TYPE_MISMATCH;
+    }
+    return toNumber(pOut) ? DocError::NONE : DocError::CONVERSION_FAILED;
+  }
+
+  DocError::Code decode(std::string& pOut) const
+  {
+    if (isContainer()) {
+      return DocError::TYPE_MISMATCH;
+    }
+    pOut = std::string(value);
+    return DocError::NONE;
+  }
+
+  DocError::Code decode(std::string_view& pOut) const
+  {
+    if (isContainer()) {
+      return DocError::TYPE_MISMATCH;
+    }
+    pOut = value;
+    return DocError::NONE;
+  }
+
+  inline Doc* node(uint32_t pIndex) const
+  {
+    uint32_t chunk, offset;
+    DocArena::locate(pIndex, chunk, offset);
+    return arena->getChunk(chunk) + offset;
+  }
+
+  inline bool ownsArena() const { return index == DocArena::ROOT_NODE; }
+
+  inline Doc* firstChildNode() const
+  {
+    uint32_t first = content()->firstChild;
+    return first == DocArena::NO_NODE ? nullptr : node(first);
+  }
+
+  inline Doc* nextSiblingNode() const
+  {
+    return nextSibling == DocArena::NO_NODE ? nullptr : node(nextSibling);
+  }
+
+  inline Doc* parentNode() const
+  {
+    if (parent == DocArena::NO_NODE) {
+      return nullptr;
+    }
+
+    if (parent == DocArena::ROOT_NODE) {
+      return arena->getRoot();
+    }
+
+    return node(parent);
+  }
+
+  // the node holding the children, the anchored node for an alias
+  inline const Doc* content() const { return isAlias() ? node(alias) : this; }
+
+  inline Doc* content() { return isAlias() ? node(alias) : this; }
+
+  // turns this node into an alias of pTarget
+  void makeAlias(const Doc& pTarget);
+  // gives an alias its own copy of the shared children before it's modified
+  void unshare();
+  void unlinkChild(Doc* pChild);
+
+  Doc* appendChild(std::string_view pName);
+  Doc* appendChild(uint32_t pKey);
+  Doc* findChild(std::string_view pName);
+  Doc* findChild(std::string_view pName, uint64_t pHash);
+  Doc* findChild(uint32_t pKey);
+  Doc* scanChildren(uint32_t pKey) const;
+  void buildIndex();
+
+  // as findChild() but never builds an index
+  const Doc* lookupChild(std::string_view pName) const;
+  const Doc* lookupChild(std::string_view pName, uint64_t pHash) const;
+  const Doc* lookupChild(uint32_t pKey) const;
+
+  template<typename Node>
+  static void walk(Node* pNode,
+                   const PathSet& pPaths,
+                   uint32_t pEntry,
+                   Node** pOut,
+                   size_t& pFound);
+
+  Doc* findNode(std::string_view pPath);
+  Doc* findNode(const Path& pPath);
+  const Doc* lookupNode(std::string_view pPath) const;
+  const Doc* lookupNode(const Path& pPath) const;
+
+  void takeFrom(Doc& pOther);
+  // pSharing keeps aliases shared instead of expanding them, the copy is then
+  // never larger than pOther and can't fail past MAX_ALIAS_EXPANSION
+  Doc& assign(const Doc& pOther, bool pSharing);
+  void copyFrom(const Doc& pOther, bool pSharing = false);
+  void copyContent(const Doc& pOther);
+  void copyChildren(const Doc& pSource);
+  void copyChildren(const Doc& pAlias, bool pExpanding, size_t& pBudget);
+  void shareChildren(const Doc& pSource);
+  void detachChildren();
 
 private:
+  union Number
+  {
+    int64_t integer;
+    double real;
+  };
+
   Type type = NONE;
-  std::string name;
-  std::string value;
-  std::vector<Doc> children;
-  Doc* parent = nullptr;
+  uint8_t flags = 0;
+  Scalar::Kind kind = Scalar::STRING;
+  // the id of the name in the arena's key table
+  uint32_t key = KeyTable::EMPTY;
+  Number number = { 0 };
+  std::string_view value;
+  DocArena* arena = nullptr;
+  uint32_t index = DocArena::ROOT_NODE;
+  uint32_t parent = DocArena::NO_NODE;
+  uint32_t firstChild = DocArena::NO_NODE;
+  uint32_t lastChild = DocArena::NO_NODE;
+  uint32_t nextSibling = DocArena::NO_NODE;
+  uint32_t childCount = 0;
+  uint32_t childIndex = DocArena::NO_NODE;
+  // the anchored node an alias shares its children with
+  uint32_t alias = DocArena::NO_NODE;
 };
 
 std::ostream& operator<<(std::ostream& os, const Doc& doc);
@@ -179,6 +789,9 @@ template<>
 const char* Doc::getValueOr(const char* pDefault);
 
 template<>
-bool Doc::getValue();
+bool Doc::getValue() const;
+
+template<>
+std::string_view Doc::getValue() const;
 
 }
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "ChildIndex.hpp"
+#include "KeyTable.hpp"
+#include "LookupStats.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+class Doc;
+
+// Storage for every node below a document root. Nodes are addressed by index
+// and live in chunks that double in size, so a node never moves once created
+// and the whole tree is released at once when the root dies.
+//
+// Values are views: either into an input buffer retained by the arena, or
+// into the arena's own string blocks for text that had to be materialized
+// (escaped or folded scalars, copies). Names are interned in the arena's key
+// table, which keeps the same kind of views once per distinct name.
+//
+// The arena itself, its chunks, strings and child indexes come from one
+// memory resource, released with the arena.
+class DocArena
+{
+public:
+  static constexpr uint32_t NO_NODE = UINT32_MAX;
+  static constexpr uint32_t ROOT_NODE = UINT32_MAX - 1;
+
+  static constexpr uint32_t FIRST_CHUNK_BITS = 4;
+  static constexpr uint32_t MAX_CHUNKS = 32 - FIRST_CHUNK_BITS + 1;
+
+  DocArena(Doc* pRoot, std::pmr::memory_resource* pMemory);
+  ~DocArena();
+
+  // placed in memory from pMemory, the default resource when null
+  static DocArena* create(Doc* pRoot, std::pmr::memory_resource* pMemory);
+  static void destroy(DocArena* pArena);
+
+  DocArena(const DocArena&) = delete;
+  DocArena& operator=(const DocArena&) = delete;
+
+  uint32_t allocate();
+
+  // pCount nodes at once, the index of the first
+  uint32_t allocate(uint32_t pCount);
+
+  std::string_view storeString(std::string_view pString);
+  std::string_view adoptString(std::string_view pString);
+
+  void retain(std::shared_ptr<const void> pOwner, std::string_view pBytes);
+  void retainAll(const DocArena& pOther);
+  bool isRetained(std::string_view pString) const;
+
+  uint32_t createIndex();
+
+  // id of a node name in the key table, new names are adopted
+  uint32_t internKey(std::string_view pKey);
+  uint32_t internKey(std::string_view pKey, uint64_t pHash);
+
+  // id of the name of the pIndex-th item of a sequence
+  uint32_t itemKey(uint32_t pIndex);
+
+  inline const KeyTable& getKeys() const { return keys; }
+  inline KeyTable& getKeys() { return keys; }
+
+  inline std::string_view getKey(uint32_t pKey) const
+  {
+    return keys.get(pKey);
+  }
+
+  // replaces the key table with the one of pOther, so nodes copied from it
+  // keep their key ids. pMove gives the text of each key in this arena.
+  template<typename Move>
+  void copyKeys(const DocArena& pOther, Move pMove)
+  {
+    keys = pOther.keys;
+    keys.relocate(pMove);
+  }
+
+  inline ChildIndex& getIndex(uint32_t pIndex) { return indexes[pIndex]; }
+
+  inline Doc* getRoot() const { return root; }
+
+  inline std::pmr::memory_resource* getMemory() const { return memory; }
+
+  // the input the tree was parsed from, empty once the tree was modified or
+  // when it wasn't parsed from a single retained buffer
+  inline std::string_view getSource() const { return source; }
+
+  inline void setSource(std::string_view pSource) { source = pSource; }
+
+  inline void setRoot(Doc* pRoot) { root = pRoot; }
+
+  inline LookupStats* getLookupStats() const
+  {
+    return lookupStats.load(std::memory_order_relaxed);
+  }
+
+  inline void setLookupStats(LookupStats* pStats)
+  {
+    lookupStats.store(pStats, std::memory_order_relaxed);
+  }
+
+  // node chunks, string blocks and child indexes
+  size_t countAllocations() const;
+
+  // bytes copied by storeString()
+  inline size_t getStoredBytes() const { return storedBytes; }
+
+  inline uint32_t size() const { return count; }
+
+  inline Doc* getChunk(uint32_t pChunk) const { return chunks[pChunk]; }
+
+  static inline void locate(uint32_t pIndex,
+                            uint32_t& pChunk,
+                            uint32_t& pOffset)
+  {
+    pChunk = std::bit_width((pIndex >> FIRST_CHUNK_BITS) + 1) - 1;
+    pOffset = pIndex + (1u << FIRST_CHUNK_BITS) -
+              ((1u << FIRST_CHUNK_BITS) << pChunk);
+  }
+
+  static inline size_t chunkCapacity(uint32_t pChunk)
+  {
+    return size_t(1) << (FIRST_CHUNK_BITS + pChunk);
+  }
+
+private:
+  struct RetainedBuffer
+  {
+    std::shared_ptr<const void> owner;
+    std::string_view bytes;
+  };
+
+  struct StringBlock
+  {
+    char* data;
+    size_t size;
+  };
+
+  static constexpr size_t FIRST_STRING_BLOCK = 256;
+  static constexpr size_t MAX_STRING_BLOCK = 64 * 1024;
+
+  char* allocateBlock(size_t pSize);
+
+  Doc* root;
+  std::pmr::memory_resource* memory;
+  Doc* chunks[MAX_CHUNKS] = {};
+  uint32_t count = 0;
+
+  std::pmr::vector<StringBlock> stringBlocks;
+  char* stringCursor = nullptr;
+  size_t stringAvailable = 0;
+  size_t nextStringBlock = FIRST_STRING_BLOCK;
+  size_t storedBytes = 0;
+
+  std::pmr::vector<RetainedBuffer> buffers;
+  std::string_view source;
+
+  std::pmr::vector<ChildIndex> indexes;
+
+  KeyTable keys;
+
+  std::atomic<LookupStats*> lookupStats = nullptr;
+};
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace YAML {
+
+// What Doc::reloadString() and Doc::reloadFile() found different from the
+// previous document, as dotted paths from the root. Only the outermost
+// difference is listed: a mapping or sequence that gained, lost or changed
+// entries isn't itself modified, and nothing is listed below an added or
+// removed node. A node that changed type is modified.
+struct DocChanges
+{
+  std::vector<std::string> added;
+  std::vector<std::string> removed;
+  std::vector<std::string> modified;
+
+  inline bool empty() const
+  {
+    return added.empty() && removed.empty() && modified.empty();
+  }
+
+  inline void clear()
+  {
+    added.clear();
+    removed.clear();
+    modified.clear();
+  }
+};
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ChildIndex.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+
+namespace YAML {
+
+// Binds the members of a struct to the keys of a mapping, so that
+// Doc::getValue<T>() decodes it in a single pass over the mapping's children,
+// each key going straight to its member. Members keep their default value
+// when their key is missing, and may be scalars, std::string, other bound
+// structs or vectors of any of those. Declared at global scope, with up to 80
+// members:
+//
+//   struct InventoryItem
+//   {
+//     std::string item = "unknown";
+//     int quantity = 1;
+//   };
+//
+//   YAML_DOC_FIELDS(InventoryItem, item, quantity)
+template<typename T>
+struct DocFields;
+
+template<typename T>
+concept Bound = requires { DocFields<T>::fields; };
+
+template<typename T, typename Member>
+struct DocField
+{
+  std::string_view key;
+  uint64_t hash;
+  Member T::*member;
+};
+
+template<typename T, typename Member>
+constexpr DocField<T, Member> field(std::string_view pKey, Member T::*pMember)
+{
+  return { pKey, hashKey(pKey), pMember };
+}
+
+}
+
+// applies pMacro(pType, member) to every member, separated by commas
+#define YAML_DOC_PARENS ()
+#define YAML_DOC_EXPAND(...)                                                   \
+  YAML_DOC_EXPAND4(YAML_DOC_EXPAND4(YAML_DOC_EXPAND4(__VA_ARGS__)))
+#define YAML_DOC_EXPAND4(...)                                                  \
+  YAML_DOC_EXPAND3(YAML_DOC_EXPAND3(YAML_DOC_EXPAND3(__VA_ARGS__)))
+#define YAML_DOC_EXPAND3(...)                                                  \
+  YAML_DOC_EXPAND2(YAML_DOC_EXPAND2(YAML_DOC_EXPAND2(__VA_ARGS__)))
+#define YAML_DOC_EXPAND2(...)                                                  \
+  YAML_DOC_EXPAND1(YAML_DOC_EXPAND1(YAML_DOC_EXPAND1(__VA_ARGS__)))
+#define YAML_DOC_EXPAND1(...) __VA_ARGS__
+#define YAML_DOC_FOR_EACH(pMacro, pType, ...)                                  \
+  __VA_OPT__(                                                                  \
+    YAML_DOC_EXPAND(YAML_DOC_FOR_EACH_NEXT(pMacro, pType, __VA_ARGS__)))
+#define YAML_DOC_FOR_EACH_NEXT(pMacro, pType, pMember, ...)                    \
+  pMacro(pType, pMember) __VA_OPT__(                                           \
+    , YAML_DOC_FOR_EACH_AGAIN YAML_DOC_PARENS(pMacro, pType, __VA_ARGS__))
+#define YAML_DOC_FOR_EACH_AGAIN() YAML_DOC_FOR_EACH_NEXT
+
+#define YAML_DOC_FIELD(pType, pMember) YAML::field(#pMember, &pType::pMember)
+
+#define YAML_DOC_FIELDS(pType, ...)                                            \
+  template<>                                                                   \
+  struct YAML::DocFields<pType>                                                \
+  {                                                                            \
+    static constexpr auto fields = std::make_tuple(                            \
+      YAML_DOC_FOR_EACH(YAML_DOC_FIELD, pType, __VA_ARGS__));                  \
+  };
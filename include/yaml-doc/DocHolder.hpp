@@ -0,0 +1,64 @@
+#pragma once
+
+#include "FrozenDoc.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace YAML {
+
+// Hands the current version of a document to reader threads while a writer
+// publishes new ones. Readers never wait on a publish, a version stays alive
+// as long as a reader holds it and is released with its last holder.
+//
+//   YAML::DocHolder config(YAML::Doc::parseFile("platform.yaml"));
+//   // writer
+//   config.publish(YAML::Doc::reloadFile(config.get()->get(), path));
+//   // readers
+//   thread_local YAML::DocHolder::Reader reader(config);
+//   int port = reader.get().getValue<int>("server.port");
+class DocHolder
+{
+public:
+  DocHolder();
+  explicit DocHolder(Doc pDoc);
+
+  DocHolder(const DocHolder&) = delete;
+  DocHolder& operator=(const DocHolder&) = delete;
+
+  // the current version, never null
+  std::shared_ptr<const FrozenDoc> get() const;
+
+  // freezes pDoc and makes it the current version
+  void publish(Doc pDoc);
+  void publish(std::shared_ptr<const FrozenDoc> pDoc);
+
+  // incremented by every publish
+  inline uint64_t getVersion() const
+  {
+    return version.load(std::memory_order_acquire);
+  }
+
+  // A per thread cache of the current version: get() only reads the version
+  // counter until something new is published. The cached version is kept
+  // until then, even if the holder moved on.
+  class Reader
+  {
+  public:
+    explicit Reader(const DocHolder& pHolder);
+
+    const Doc& get();
+
+  private:
+    const DocHolder& holder;
+    std::shared_ptr<const FrozenDoc> current;
+    uint64_t version;
+  };
+
+private:
+  std::atomic<std::shared_ptr<const FrozenDoc>> current;
+  std::atomic<uint64_t> version = 0;
+};
+
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace YAML {
+
+class Doc;
+
+// Iterators over the nodes stored in a document. They walk the sibling and
+// parent links of the existing nodes and never copy them. Node is Doc or
+// const Doc. Traversals visit aliases but don't walk into the subtree they
+// share, which is walked where it's anchored.
+
+template<typename Node>
+class BasicChildIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Doc;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Node*;
+  using reference = Node&;
+
+  BasicChildIterator() = default;
+  BasicChildIterator(Node* pNode)
+    : current(pNode)
+  {
+  }
+
+  inline reference operator*() const { return *current; }
+
+  inline pointer operator->() const { return current; }
+
+  inline BasicChildIterator& operator++()
+  {
+    current = current->getNextSibling();
+    return *this;
+  }
+
+  inline BasicChildIterator operator++(int)
+  {
+    BasicChildIterator previous = *this;
+    ++*this;
+    return previous;
+  }
+
+  inline bool operator==(const BasicChildIterator& pOther) const = default;
+
+private:
+  Node* current = nullptr;
+};
+
+template<typename Node>
+class BasicChildRange
+{
+public:
+  using iterator = BasicChildIterator<Node>;
+
+  BasicChildRange(Node* pParent)
+    : parent(pParent)
+  {
+  }
+
+  inline iterator begin() const { return iterator(parent->getFirstChild()); }
+
+  inline iterator end() const { return iterator(); }
+
+  inline size_t size() const { return parent->getChildCount(); }
+
+  inline bool empty() const { return parent->getChildCount() == 0; }
+
+private:
+  Node* parent;
+};
+
+// Preorder walk over every node below a root, the root itself excluded.
+template<typename Node>
+class BasicDepthFirstIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Doc;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Node*;
+  using reference = Node&;
+
+  BasicDepthFirstIterator() = default;
+  BasicDepthFirstIterator(Node* pRoot)
+    : current(pRoot->getFirstChild())
+  {
+    // the children of an alias have the anchored node as parent
+    root = current ? current->getParent() : nullptr;
+  }
+
+  inline reference operator*() const { return *current; }
+
+  inline pointer operator->() const { return current; }
+
+  // depth below the root, its children are at depth 1
+  inline size_t depth() const { return level; }
+
+  BasicDepthFirstIterator& operator++()
+  {
+    Node* child = current->isAlias() ? nullptr : current->getFirstChild();
+    if (child) {
+      current = child;
+      level++;
+      return *this;
+    }
+
+    while (current != nullptr) {
+      if (Node* sibling = current->getNextSibling()) {
+        current = sibling;
+        return *this;
+      }
+
+      current = current->getParent();
+      level--;
+      if (current == root) {
+        current = nullptr;
+      }
+    }
+
+    return *this;
+  }
+
+  inline BasicDepthFirstIterator operator++(int)
+  {
+    BasicDepthFirstIterator previous = *this;
+    ++*this;
+    return previous;
+  }
+
+  inline bool operator==(const BasicDepthFirstIterator& pOther) const
+  {
+    return current == pOther.current;
+  }
+
+private:
+  Node* root = nullptr;
+  Node* current = nullptr;
+  size_t level = 1;
+};
+
+// Level order walk over every node below a root, the root itself excluded.
+// Only nodes that have children are queued, so walking a sequence of scalars
+// doesn't allocate.
+template<typename Node>
+class BasicBreadthFirstIterator
+{
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Doc;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Node*;
+  using reference = Node&;
+
+  BasicBreadthFirstIterator() = default;
+  BasicBreadthFirstIterator(Node* pRoot)
+    : current(pRoot->getFirstChild())
+  {
+    enqueue();
+  }
+
+  inline reference operator*() const { return *current; }
+
+  inline pointer operator->() const { return current; }
+
+  BasicBreadthFirstIterator& operator++()
+  {
+    current = current->getNextSibling();
+    while (current == nullptr && next < pending.size()) {
+      current = pending[next++]->getFirstChild();
+    }
+    enqueue();
+    return *this;
+  }
+
+  inline bool operator==(const BasicBreadthFirstIterator& pOther) const
+  {
+    return current == pOther.current;
+  }
+
+private:
+  inline void enqueue()
+  {
+    if (current != nullptr && !current->isAlias() &&
+        current->getChildCount() > 0) {
+      pending.push_back(current);
+    }
+  }
+
+private:
+  Node* current = nullptr;
+  std::vector<Node*> pending;
+  size_t next = 0;
+};
+
+template<typename Iterator, typename Node>
+class BasicTraversal
+{
+public:
+  BasicTraversal(Node* pRoot)
+    : root(pRoot)
+  {
+  }
+
+  inline Iterator begin() const { return Iterator(root); }
+
+  inline Iterator end() const { return Iterator(); }
+
+private:
+  Node* root;
+};
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+namespace YAML {
+
+// Why a lookup or a conversion of Doc failed, without throwing
+class DocError
+{
+public:
+  enum Code : uint8_t
+  {
+    NONE,
+    // no node at the path
+    NOT_FOUND,
+    // a scalar that doesn't hold a T, or holds one out of its range
+    CONVERSION_FAILED,
+    // a mapping or sequence asked for a scalar, or the other way around
+    TYPE_MISMATCH
+  };
+
+  static constexpr const char* describe(Code pCode)
+  {
+    switch (pCode) {
+      case NONE:
+        return "none";
+      case NOT_FOUND:
+        return "not found";
+      case CONVERSION_FAILED:
+        return "conversion failed";
+      case TYPE_MISMATCH:
+        return "type mismatch";
+    }
+    return "unknown";
+  }
+};
+
+// A T or the reason there isn't one, like std::expected. What the non
+// throwing lookups of Doc return, the throwing ones are built on them:
+//
+//   YAML::DocResult<int> port = doc.lookupValue<int>("server.port");
+//   if (!port && port.getError() == YAML::DocError::NOT_FOUND) {
+//     ...
+//   }
+//   int timeout = doc.lookupValue<int>("server.timeout").getValueOr(30);
+template<typename T>
+class DocResult
+{
+public:
+  DocResult(T pValue)
+    : value(std::move(pValue))
+  {
+  }
+
+  DocResult(DocError::Code pError)
+    : error(pError)
+  {
+  }
+
+  inline bool hasValue() const { return error == DocError::NONE; }
+
+  inline explicit operator bool() const { return hasValue(); }
+
+  inline DocError::Code getError() const { return error; }
+
+  // only meaningful when hasValue()
+  inline T& operator*() { return value; }
+
+  inline const T& operator*() const { return value; }
+
+  inline T* operator->() { return &value; }
+
+  inline const T* operator->() const { return &value; }
+
+  inline T getValueOr(T pDefault) const&
+  {
+    return hasValue() ? value : std::move(pDefault);
+  }
+
+  inline T getValueOr(T pDefault) &&
+  {
+    return hasValue() ? std::move(value) : std::move(pDefault);
+  }
+
+private:
+  T value{};
+  DocError::Code error = DocError::NONE;
+};
+
+}
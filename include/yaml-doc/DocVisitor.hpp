@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string_view>
+
+namespace YAML {
+
+// Receives the content of a YAML stream as it is parsed, in document order,
+// without any node being built. Every callback gets the dotted path of the
+// node it is about ("inventory.2.item", empty for the top level node), the
+// same path getNode() would take. Views passed to callbacks are only valid
+// during the call.
+//
+//   class DamageSum : public YAML::DocVisitor
+//   {
+//     void onScalar(std::string_view pPath, std::string_view pValue,
+//                   std::string_view pTag, bool pPlain) override;
+//   };
+//
+//   DamageSum sum;
+//   YAML::Doc::parseFile("inventory.yaml", sum);
+class DocVisitor
+{
+public:
+  virtual ~DocVisitor() = default;
+
+  virtual void onDocumentStart() {}
+
+  virtual void onDocumentEnd() {}
+
+  virtual void onMappingStart(std::string_view /*pPath*/) {}
+
+  virtual void onMappingEnd(std::string_view /*pPath*/) {}
+
+  virtual void onSequenceStart(std::string_view /*pPath*/) {}
+
+  virtual void onSequenceEnd(std::string_view /*pPath*/) {}
+
+  // a mapping key, pPath already ends with it; the value follows as a
+  // scalar, mapping, sequence or alias event with the same path. pPlain is
+  // false for quoted keys, only a plain "<<" is a merge key.
+  virtual void onKey(std::string_view /*pPath*/,
+                     std::string_view /*pKey*/,
+                     bool /*pPlain*/)
+  {
+  }
+
+  // pTag is empty for untagged scalars, pPlain is false for quoted and block
+  // scalars which are always strings
+  virtual void onScalar(std::string_view /*pPath*/,
+                        std::string_view /*pValue*/,
+                        std::string_view /*pTag*/,
+                        bool /*pPlain*/)
+  {
+  }
+
+  // the value at pPath, announced by the next event, is anchored as pAnchor
+  // so that later aliases can refer to it
+  virtual void onAnchor(std::string_view /*pPath*/,
+                        std::string_view /*pAnchor*/)
+  {
+  }
+
+  virtual void onAlias(std::string_view /*pPath*/,
+                       std::string_view /*pAnchor*/)
+  {
+  }
+};
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace YAML {
+
+class Doc;
+
+// Writes documents out in a single pass over their nodes, through a buffer of
+// BUFFER_SIZE bytes handed to the sink each time it fills up, so memory stays
+// flat whatever the size of the document. Deep trees are walked without
+// recursion.
+//
+//   std::ofstream out("resolved.yaml");
+//   YAML::DocWriter(out).writeYaml(doc);
+class DocWriter
+{
+public:
+  using Sink = std::function<void(std::string_view)>;
+
+  static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+  DocWriter(std::ostream& pOut);
+  DocWriter(Sink pSink);
+  ~DocWriter();
+
+  DocWriter(const DocWriter&) = delete;
+  DocWriter& operator=(const DocWriter&) = delete;
+
+  // block style YAML that parses back to the same tree. Scalars are quoted or
+  // tagged when needed to keep their kind. An alias is written as an alias of
+  // its anchored node when that node was written before it, and expanded
+  // otherwise, up to Doc::MAX_ALIAS_EXPANSION nodes.
+  void writeYaml(const Doc& pNode);
+
+  // the indented tree of Doc::toString(), aliases expanded
+  void writeTree(const Doc& pNode, int pDepth = 0);
+
+  // hands whatever is buffered to the sink, also done on destruction
+  void flush();
+
+private:
+  void writeScalar(const Doc& pNode);
+  void writeKey(std::string_view pKey);
+  void writeQuoted(std::string_view pText);
+  void writeIndent(size_t pIndent);
+
+  inline void put(char pChar)
+  {
+    buffer += pChar;
+    if (buffer.size() >= BUFFER_SIZE) {
+      flush();
+    }
+  }
+
+  inline void put(std::string_view pText)
+  {
+    if (buffer.size() + pText.size() > BUFFER_SIZE) {
+      flush();
+      // large scalars skip the buffer rather than growing it
+      if (pText.size() >= BUFFER_SIZE) {
+        sink(pText);
+        return;
+      }
+    }
+    buffer += pText;
+  }
+
+private:
+  Sink sink;
+  std::string buffer;
+};
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Doc.hpp"
+
+namespace YAML {
+
+// A document that won't change anymore. Every wide node gets its child index
+// up front, so the const lookups of Doc find children by hash and can be
+// called from any number of threads at once without a lock.
+//
+//   auto config = std::make_shared<const YAML::FrozenDoc>(std::move(doc));
+//   int port = config->get().getValue<int>("server.port");
+class FrozenDoc
+{
+public:
+  explicit FrozenDoc(Doc pDoc);
+
+  FrozenDoc(const FrozenDoc&) = delete;
+  FrozenDoc& operator=(const FrozenDoc&) = delete;
+
+  inline const Doc& get() const { return doc; }
+
+  inline const Doc& operator*() const { return doc; }
+
+  inline const Doc* operator->() const { return &doc; }
+
+private:
+  Doc doc;
+};
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ChildIndex.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+// The names of the nodes of a document, each distinct name stored once.
+// Nodes hold the id of their name, lookups resolve a path segment to an id
+// once then compare ids. Id 0 is the empty name, id 1 the root's.
+//
+// The names of sequence items, 0, 1, 2..., are made in order as sequences
+// grow and found by their number rather than hashed. Other names are
+// scanned until there are enough of them to hash.
+class KeyTable
+{
+public:
+  static constexpr uint32_t NOT_FOUND = ChildIndex::NOT_FOUND;
+  static constexpr uint32_t EMPTY = 0;
+  static constexpr uint32_t ROOT = 1;
+
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  explicit KeyTable(const allocator_type& pAllocator = {});
+
+  // NOT_FOUND when no node is named pKey
+  uint32_t find(std::string_view pKey, uint64_t pHash) const
+  {
+    if (pKey.empty()) {
+      return EMPTY;
+    }
+
+    uint32_t item;
+    if (isItem(pKey, item) && item < items.size()) {
+      return items[item];
+    }
+    return findHashed(pKey, pHash);
+  }
+
+  // pStore returns a copy of a new key that outlives the table
+  template<typename Store>
+  uint32_t intern(std::string_view pKey, uint64_t pHash, Store pStore)
+  {
+    uint32_t found = find(pKey, pHash);
+    if (found != NOT_FOUND) {
+      return found;
+    }
+
+    uint32_t item;
+    if (isItem(pKey, item)) {
+      numbered++;
+    }
+    return add(pStore(pKey), pHash, true);
+  }
+
+  // the name of the pIndex-th item of a sequence
+  template<typename Store>
+  uint32_t internItem(uint32_t pIndex, Store pStore)
+  {
+    if (items.empty()) {
+      items.reserve(ChildIndex::THRESHOLD);
+    }
+    while (items.size() <= pIndex) {
+      char digits[16];
+      char* end =
+        std::to_chars(digits, digits + sizeof(digits), items.size()).ptr;
+      std::string_view key(digits, end - digits);
+      uint64_t hash = hashKey(key);
+
+      // unless a mapping used it as a key first, items aren't hashed
+      uint32_t id = numbered > 0 ? findHashed(key, hash) : NOT_FOUND;
+      if (id == NOT_FOUND) {
+        id = add(pStore(key), hash, false);
+      }
+      items.push_back(id);
+    }
+
+    return items[pIndex];
+  }
+
+  inline std::string_view get(uint32_t pId) const
+  {
+    return std::string_view(keys[pId].data, keys[pId].size);
+  }
+
+  // the bits of hashKey() a key was interned with
+  inline uint32_t getHash(uint32_t pId) const { return keys[pId].hash; }
+
+  inline uint32_t size() const { return static_cast<uint32_t>(keys.size()); }
+
+  // what child indexes hash children by. Keys made one after the other land
+  // in neighbouring slots, the folding keeps ids a power of two apart from
+  // all landing in one.
+  static constexpr uint32_t hashId(uint32_t pId)
+  {
+    return pId ^ (pId >> 8) ^ (pId >> 16);
+  }
+
+  // true when pKey is written as sequences name their items
+  static bool isItem(std::string_view pKey, uint32_t& pIndex)
+  {
+    if (pKey.empty() || pKey[0] < '0' || pKey[0] > '9' ||
+        (pKey[0] == '0' && pKey.size() > 1) || pKey.size() > 9) {
+      return false;
+    }
+
+    auto [end, error] =
+      std::from_chars(pKey.data(), pKey.data() + pKey.size(), pIndex);
+    return error == std::errc() && end == pKey.data() + pKey.size();
+  }
+
+  // for a copy of the table in an arena where the text of the keys moved
+  template<typename Move>
+  void relocate(Move pMove)
+  {
+    for (Key& key : keys) {
+      std::string_view moved = pMove(std::string_view(key.data, key.size));
+      key.data = moved.data();
+    }
+  }
+
+private:
+  struct Key
+  {
+    const char* data;
+    uint32_t size;
+    uint32_t hash;
+  };
+
+  // finds the keys that aren't only item names
+  uint32_t findHashed(std::string_view pKey, uint64_t pHash) const;
+  uint32_t add(std::string_view pKey, uint64_t pHash, bool pHashed);
+
+  inline bool isHashed() const { return keys.size() > ChildIndex::THRESHOLD; }
+
+private:
+  std::pmr::vector<Key> keys;
+  ChildIndex slots;
+  // ids of the item names, by number
+  std::pmr::vector<uint32_t> items;
+  // item names interned as mapping keys before any sequence reached them
+  uint32_t numbered = 0;
+};
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace YAML {
+
+// Counts the path lookups made in a document, see Doc::setLookupStats(). The
+// counters are atomic so lookups on several threads can share them.
+struct LookupStats
+{
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+  // path segments asked for, and the ones searched among the children of a
+  // node before the lookup hit or missed
+  std::atomic<uint64_t> segments = 0;
+  std::atomic<uint64_t> segmentsCompared = 0;
+
+  inline double averageDepth() const
+  {
+    uint64_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : double(segments) / lookups;
+  }
+
+  void reset()
+  {
+    hits = 0;
+    misses = 0;
+    segments = 0;
+    segmentsCompared = 0;
+  }
+};
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ParseStats.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace YAML {
+
+// Settings of parseFile() and parseString()
+struct ParseOptions
+{
+  ParseOptions() = default;
+
+  // build the tree with the in-tree block scanner when the input only uses
+  // the block subset it handles, libyaml parses everything else
+  bool fastScan = true;
+
+  // memory map the file in parseFile() and parseAllFile() instead of reading
+  // it into the document: no copy, but names and values stay views into the
+  // mapping. While a document parsed from it is alive the file must be
+  // replaced (written aside then renamed), rewriting it in place changes its
+  // strings and truncating it crashes their readers (SIGBUS).
+  bool mapFile = false;
+
+  // threads splitting the documents of a stream between them in
+  // parseAllFile() and parseAllString(), 0 for one per core. Streams smaller
+  // than PARALLEL_THRESHOLD bytes are parsed on the calling thread.
+  unsigned threads = 0;
+
+  // directory where parseFile() keeps a binary snapshot of each file it
+  // parses, reused instead of parsing while the file keeps its path, size and
+  // modification time. Empty to always parse.
+  std::string snapshotCache;
+
+  // filled with what parseFile() or parseString() went through, off when
+  // null. Not filled by parseAllFile() and parseAllString().
+  ParseStats* stats = nullptr;
+
+  // where the documents keep their nodes, strings, indexes and the copy of a
+  // parsed string, the default resource when null. It must outlive them, and
+  // be thread safe when parseAllFile() or parseAllString() use several
+  // threads, like std::pmr::synchronized_pool_resource.
+  std::pmr::memory_resource* memory = nullptr;
+
+  static constexpr size_t PARALLEL_THRESHOLD = 1 << 20;
+};
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace YAML {
+
+// What parseFile() or parseString() went through, filled when
+// ParseOptions::stats points to one. Everything is cleared at the start of
+// each parse.
+struct ParseStats
+{
+  // size of the input
+  size_t bytes = 0;
+  // whether the block scanner built the document, libyaml did otherwise
+  bool fastScanned = false;
+  // whether parseFile() loaded it from ParseOptions::snapshotCache
+  bool fromSnapshot = false;
+  // libyaml events handled, none when the block scanner built the document
+  size_t events = 0;
+
+  // nodes of the document indexed by Doc::Type, the root included
+  size_t nodesByType[5] = {};
+  size_t aliases = 0;
+  // levels below the root of the deepest node
+  size_t maxDepth = 0;
+  // children of the widest mapping
+  size_t widestMapping = 0;
+
+  // length of every name and value, and the bytes the document holds in its
+  // own storage rather than as views into the input
+  size_t keyBytes = 0;
+  size_t valueBytes = 0;
+  size_t storedBytes = 0;
+  // distinct names in the document's key table, the empty one included
+  size_t keys = 0;
+  // node chunks, string blocks and child index tables of the document
+  size_t allocations = 0;
+
+  // the block scanner scans and builds in the same pass, its time includes
+  // an attempt it gave up on. libyaml's is split between producing events and
+  // building nodes out of them.
+  double fastScanSeconds = 0;
+  double eventSeconds = 0;
+  double buildSeconds = 0;
+  double totalSeconds = 0;
+};
+
+}
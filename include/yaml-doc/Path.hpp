@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ChildIndex.hpp"
+#include "exceptions/DocNodeException.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace YAML {
+
+// A dotted node path ("inventory.2.item") split and hashed once, so repeated
+// lookups only walk the tree. Like std::string_view a Path refers to the
+// string it was built from, which must outlive it; string literals always
+// do, and paths built from them can be constexpr:
+//
+//   static constexpr YAML::Path swordName("equipment.sword.name");
+//   doc.getValue(swordName);
+class Path
+{
+public:
+  static constexpr size_t MAX_SEGMENTS = 16;
+
+  struct Segment
+  {
+    std::string_view key;
+    uint64_t hash;
+  };
+
+  constexpr Path() = default;
+
+  constexpr explicit Path(const char* pPath)
+    : Path(std::string_view(pPath))
+  {
+  }
+
+  constexpr explicit Path(std::string_view pPath)
+    : path(pPath)
+  {
+    if (pPath.empty()) {
+      return;
+    }
+
+    size_t start = 0;
+    while (true) {
+      size_t end = pPath.find('.', start);
+      if (end == std::string_view::npos) {
+        end = pPath.size();
+      }
+
+      if (count == MAX_SEGMENTS) {
+        throw DocNodeException("Path " + std::string(pPath) + " has more than " +
+                               std::to_string(MAX_SEGMENTS) + " segments");
+      }
+
+      std::string_view key = pPath.substr(start, end - start);
+      segments[count++] = { key, hashKey(key) };
+
+      if (end == pPath.size()) {
+        break;
+      }
+      start = end + 1;
+    }
+  }
+
+  // a temporary string would leave the path dangling
+  explicit Path(std::string&& pPath) = delete;
+
+  inline constexpr size_t size() const { return count; }
+
+  inline constexpr bool empty() const { return count == 0; }
+
+  inline constexpr const Segment* begin() const { return segments; }
+
+  inline constexpr const Segment* end() const { return segments + count; }
+
+  inline constexpr const Segment& operator[](size_t pIndex) const
+  {
+    return segments[pIndex];
+  }
+
+  inline constexpr std::string_view str() const { return path; }
+
+private:
+  std::string_view path;
+  Segment segments[MAX_SEGMENTS] = {};
+  size_t count = 0;
+};
+
+namespace literals {
+consteval Path operator""_path(const char* pPath, size_t pLength)
+{
+  return Path(std::string_view(pPath, pLength));
+}
+}
+
+}
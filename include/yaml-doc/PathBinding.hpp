@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Doc.hpp"
+#include "PathSet.hpp"
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+// Binds members of a T to paths below a node, then fills a T from all of
+// them in one walk of the document, see PathSet. Members keep their value
+// when their path is missing, and may be anything Doc::convert() reads:
+//
+//   YAML::PathBinding<Settings> binding;
+//   binding.bind("server.port", &Settings::port)
+//     .bind("server.host", &Settings::host);
+//   YAML::DocResult<Settings> settings = binding.decode(doc);
+template<typename T>
+class PathBinding
+{
+public:
+  template<typename Member>
+  PathBinding& bind(std::string_view pPath, Member T::*pMember)
+  {
+    size_t path = paths.add(pPath);
+    setters.push_back({ path, [pMember](const Doc& pNode, T& pOut) {
+                         DocResult<Member> value = pNode.convert<Member>();
+                         if (!value) {
+                           return value.getError();
+                         }
+                         pOut.*pMember = std::move(*value);
+                         return DocError::NONE;
+                       } });
+    return *this;
+  }
+
+  // stops at the first member that doesn't convert, the ones bound before it
+  // are set
+  DocError::Code decode(const Doc& pNode, T& pOut) const
+  {
+    std::vector<const Doc*> found(paths.size());
+    pNode.lookup(paths, found.data());
+    for (const Setter& setter : setters) {
+      const Doc* node = found[setter.path];
+      if (node == nullptr) {
+        continue;
+      }
+
+      DocError::Code error = setter.set(*node, pOut);
+      if (error != DocError::NONE) {
+        return error;
+      }
+    }
+    return DocError::NONE;
+  }
+
+  DocResult<T> decode(const Doc& pNode) const
+  {
+    T returnValue{};
+    DocError::Code error = decode(pNode, returnValue);
+    if (error != DocError::NONE) {
+      return error;
+    }
+    return returnValue;
+  }
+
+  inline const PathSet& getPaths() const { return paths; }
+
+private:
+  struct Setter
+  {
+    size_t path;
+    std::function<DocError::Code(const Doc&, T&)> set;
+  };
+
+  PathSet paths;
+  std::vector<Setter> setters;
+};
+
+}
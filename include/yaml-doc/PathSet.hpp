@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ChildIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+// Dotted paths compiled into a prefix tree, so that Doc::lookup() finds all
+// of them in a single walk of the document: a prefix shared by several paths
+// is looked up once. Unlike Path the set keeps a copy of what it was given.
+//
+//   YAML::PathSet paths;
+//   size_t port = paths.add("server.port");
+//   size_t host = paths.add("server.host");
+//   std::vector<const YAML::Doc*> found(paths.size());
+//   doc.lookup(paths, found.data());
+class PathSet
+{
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  PathSet();
+  PathSet(std::initializer_list<std::string_view> pPaths);
+  PathSet(const std::vector<std::string>& pPaths);
+
+  // where the node of pPath goes in the results, adding a path again returns
+  // the place it already has
+  size_t add(std::string_view pPath);
+
+  inline size_t size() const { return paths.size(); }
+
+  inline bool empty() const { return paths.empty(); }
+
+  std::string getPath(size_t pIndex) const;
+
+  // segments of all the paths, and the ones left once shared prefixes are
+  // counted once
+  inline size_t segmentCount() const { return segments; }
+
+  inline size_t entryCount() const { return entries.size() - 1; }
+
+private:
+  friend class Doc;
+
+  // a segment of one or more paths, entry 0 is the empty path
+  struct Entry
+  {
+    uint32_t offset;
+    uint32_t size;
+    uint64_t hash;
+    uint32_t parent = NONE;
+    uint32_t firstChild = NONE;
+    uint32_t lastChild = NONE;
+    uint32_t nextSibling = NONE;
+    // the path ending here
+    uint32_t path = NONE;
+  };
+
+  inline std::string_view key(const Entry& pEntry) const
+  {
+    return std::string_view(text).substr(pEntry.offset, pEntry.size);
+  }
+
+  uint32_t child(uint32_t pParent, std::string_view pKey);
+
+private:
+  std::string text;
+  std::vector<Entry> entries;
+  // the entry each path ends at
+  std::vector<uint32_t> paths;
+  size_t segments = 0;
+};
+
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace YAML {
+
+// Scalar resolution following the YAML 1.2 core schema. Plain scalars are
+// classified once while parsing and numbers are decoded at the same time, so
+// later conversions are a cast and a range check. None of these functions
+// allocate, throw or depend on the locale.
+class Scalar
+{
+public:
+  enum Kind : uint8_t
+  {
+    // quoted, block or not classified: converted from the text on demand
+    STRING,
+    NULL_VALUE,
+    BOOLEAN,
+    INTEGER,
+    FLOAT
+  };
+
+  static bool isNull(std::string_view pText);
+
+  static bool parseBool(std::string_view pText, bool& pOut);
+
+  // [-+]?[0-9]+, 0o[0-7]+ and 0x[0-9a-fA-F]+
+  static bool parseInteger(std::string_view pText, int64_t& pOut);
+
+  // [-+]?(\.[0-9]+|[0-9]+(\.[0-9]*)?)([eE][-+]?[0-9]+)?, [-+]?.inf and .nan
+  static bool parseFloat(std::string_view pText, double& pOut);
+
+  // resolves a plain scalar, filling pInteger for integers and booleans (as
+  // 0 or 1) or pFloat for floats
+  static Kind classify(std::string_view pText,
+                       int64_t& pInteger,
+                       double& pFloat);
+
+  // like classify() but honours an explicit tag (!!str, !!int, ...), any
+  // other tag resolves to a string
+  static Kind classify(std::string_view pText,
+                       std::string_view pTag,
+                       int64_t& pInteger,
+                       double& pFloat);
+
+  template<typename T>
+  static bool fromInteger(int64_t pValue, T& pOut)
+  {
+    if constexpr (std::is_floating_point_v<T>) {
+      pOut = static_cast<T>(pValue);
+      return true;
+    } else if constexpr (std::is_signed_v<T>) {
+      if (pValue < std::numeric_limits<T>::min() ||
+          pValue > std::numeric_limits<T>::max()) {
+        return false;
+      }
+      pOut = static_cast<T>(pValue);
+      return true;
+    } else {
+      if (pValue < 0 ||
+          static_cast<uint64_t>(pValue) > std::numeric_limits<T>::max()) {
+        return false;
+      }
+      pOut = static_cast<T>(pValue);
+      return true;
+    }
+  }
+
+  template<typename T>
+  static bool fromFloat(double pValue, T& pOut)
+  {
+    if constexpr (std::is_floating_point_v<T>) {
+      pOut = static_cast<T>(pValue);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // converts text that wasn't classified at parse time, or doesn't fit the
+  // decoded representation (integers beyond int64_t)
+  template<typename T>
+  static bool parseNumber(std::string_view pText, T& pOut)
+  {
+    if constexpr (std::is_floating_point_v<T>) {
+      double value;
+      if (parseFloat(pText, value)) {
+        pOut = static_cast<T>(value);
+        return true;
+      }
+
+      int64_t integer;
+      if (parseInteger(pText, integer)) {
+        pOut = static_cast<T>(integer);
+        return true;
+      }
+
+      return false;
+    } else {
+      int base = 10;
+      if (pText.size() > 2 && pText[0] == '0' &&
+          (pText[1] == 'x' || pText[1] == 'o')) {
+        base = pText[1] == 'x' ? 16 : 8;
+        pText.remove_prefix(2);
+      } else if (!pText.empty() && pText[0] == '+') {
+        pText.remove_prefix(1);
+        if (!pText.empty() && pText[0] == '-') {
+          return false;
+        }
+      }
+
+      if (pText.empty() || (base != 10 && pText[0] == '-')) {
+        return false;
+      }
+
+      auto [end, error] =
+        std::from_chars(pText.data(), pText.data() + pText.size(), pOut, base);
+      return error == std::errc() && end == pText.data() + pText.size();
+    }
+  }
+};
+
+}
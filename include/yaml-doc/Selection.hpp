@@ -0,0 +1,42 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace YAML {
+
+// A set of dotted path prefixes telling parseFile() and parseString() which
+// subtrees to build. A "*" segment matches any key or sequence index:
+//
+//   YAML::Doc doc =
+//     YAML::Doc::parseFile("platform.yaml", { "database", "services.*.port" });
+//
+// Everything else is still parsed, so syntax errors are reported, but no node
+// is created for it.
+class Selection
+{
+public:
+  enum Match
+  {
+    // the node and its subtree are left out
+    OUTSIDE,
+    // the node leads to a selected subtree, its children are matched again
+    ANCESTOR,
+    // the node and its whole subtree are selected
+    INSIDE
+  };
+
+  Selection(std::initializer_list<std::string_view> pPrefixes);
+  Selection(const std::vector<std::string>& pPrefixes);
+
+  void add(std::string_view pPrefix);
+
+  Match match(std::string_view pPath) const;
+
+private:
+  std::vector<std::vector<std::string>> prefixes;
+};
+
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "exceptions/DocException.hpp"
+#include "DocException.hpp"
 namespace YAML {
 class DocNodeException : public DocException
 {
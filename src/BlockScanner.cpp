@@ -0,0 +1,383 @@
+#include "BlockScanner.hpp"
+#include "ByteScan.hpp"
+
+#include <cstring>
+
+namespace YAML {
+namespace {
+// libyaml's limit on the length of a simple key
+constexpr size_t MAX_KEY_LENGTH = 1024;
+
+const char* skipSpaces(const char* pCursor, const char* pEnd)
+{
+  while (pCursor != pEnd && *pCursor == ' ') {
+    pCursor++;
+  }
+  return pCursor;
+}
+
+std::string_view trimmed(const char* pBegin, const char* pEnd)
+{
+  while (pEnd != pBegin && pEnd[-1] == ' ') {
+    pEnd--;
+  }
+  return std::string_view(pBegin, pEnd - pBegin);
+}
+
+bool isQuote(char pChar)
+{
+  return pChar == '\'' || pChar == '"';
+}
+
+// plain scalars starting with an indicator are left to libyaml
+bool startsPlain(const char* pCursor, const char* pEnd)
+{
+  if (std::strchr("?:,[]{}#&*!|>'\"%@`", *pCursor) != nullptr) {
+    return false;
+  }
+  return *pCursor != '-' || (pCursor + 1 != pEnd && pCursor[1] != ' ');
+}
+
+// only spaces and a comment may follow a scalar
+bool endsLine(const char* pCursor, const char* pEnd)
+{
+  const char* next = skipSpaces(pCursor, pEnd);
+  return next == pEnd || (*next == '#' && next[-1] == ' ');
+}
+
+// scans a plain scalar up to the end of the line, a comment or a ": "
+// separator, telling which one in pKey
+const char* scanPlain(const char* pCursor, const char* pEnd, bool& pKey)
+{
+  pKey = false;
+  while (true) {
+    pCursor = ByteScan::findAny<':', '#'>(pCursor, pEnd);
+    if (pCursor == pEnd) {
+      return pEnd;
+    }
+    if (*pCursor == '#' && pCursor[-1] == ' ') {
+      return pCursor;
+    }
+    if (*pCursor == ':' && (pCursor + 1 == pEnd || pCursor[1] == ' ')) {
+      pKey = true;
+      return pCursor;
+    }
+    pCursor++;
+  }
+}
+
+// decodes the UTF-8 sequence at pCursor, false if it's malformed
+bool decodeUtf8(const char* pCursor,
+                const char* pEnd,
+                char32_t& pChar,
+                size_t& pLength)
+{
+  auto byte = [&](size_t pIndex) {
+    return static_cast<unsigned char>(pCursor[pIndex]);
+  };
+
+  unsigned char lead = byte(0);
+  char32_t minimum;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    pLength = 2;
+    pChar = lead & 0x1F;
+    minimum = 0x80;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    pLength = 3;
+    pChar = lead & 0x0F;
+    minimum = 0x800;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    pLength = 4;
+    pChar = lead & 0x07;
+    minimum = 0x10000;
+  } else {
+    return false;
+  }
+
+  if (static_cast<size_t>(pEnd - pCursor) < pLength) {
+    return false;
+  }
+  for (size_t i = 1; i < pLength; i++) {
+    if ((byte(i) & 0xC0) != 0x80) {
+      return false;
+    }
+    pChar = (pChar << 6) | (byte(i) & 0x3F);
+  }
+
+  return pChar >= minimum && pChar <= 0x10FFFF &&
+         (pChar < 0xD800 || pChar > 0xDFFF);
+}
+}
+
+BlockScanner::BlockScanner(std::string_view pSource)
+  : source(pSource)
+  , cursor(pSource.data())
+  , lineStart(pSource.data())
+{
+}
+
+bool BlockScanner::build(std::string_view pSource, Doc& pRoot)
+{
+  BlockScanner scanner(pSource);
+  if (!scanner.validate() || !scanner.advance()) {
+    return false;
+  }
+
+  // nothing but comments, libyaml doesn't produce a document either
+  if (!scanner.hasLine) {
+    return true;
+  }
+
+  return scanner.parseNode(&pRoot) && !scanner.hasLine;
+}
+
+bool BlockScanner::validate() const
+{
+  // libyaml rejects control characters and malformed UTF-8, and treats a few
+  // code points as line breaks or byte order marks
+  const char* end = source.data() + source.size();
+  const char* next = source.data();
+  while ((next = ByteScan::findIrregular(next, end)) != end) {
+    char32_t character;
+    size_t length;
+    if (!decodeUtf8(next, end, character, length) || character < 0xA0 ||
+        character == 0x2028 || character == 0x2029 || character == 0xFEFF ||
+        character == 0xFFFE || character == 0xFFFF) {
+      return false;
+    }
+    next += length;
+  }
+
+  return true;
+}
+
+bool BlockScanner::advance()
+{
+  const char* end = source.data() + source.size();
+  while (cursor != end) {
+    lineStart = cursor;
+    const char* lineEnd = ByteScan::findAny<'\n'>(cursor, end);
+    cursor = lineEnd == end ? end : lineEnd + 1;
+
+    const char* content = skipSpaces(lineStart, lineEnd);
+    if (content != lineEnd && *content != '#') {
+      hasLine = true;
+      return analyze(content, lineEnd);
+    }
+  }
+
+  hasLine = false;
+  return true;
+}
+
+bool BlockScanner::analyze(const char* pBegin, const char* pEnd)
+{
+  line.indent = pBegin - lineStart;
+  line.dash = false;
+  line.entryColumn = line.indent;
+  line.hasKey = false;
+  line.key = std::string_view();
+  line.value = Token();
+
+  // document markers
+  if (line.indent == 0 && pEnd - pBegin >= 3 &&
+      (std::memcmp(pBegin, "---", 3) == 0 ||
+       std::memcmp(pBegin, "...", 3) == 0) &&
+      (pEnd - pBegin == 3 || pBegin[3] == ' ')) {
+    return false;
+  }
+
+  const char* next = pBegin;
+  if (*next == '-' && (next + 1 == pEnd || next[1] == ' ')) {
+    line.dash = true;
+    next = skipSpaces(next + 1, pEnd);
+    if (next == pEnd || *next == '#') {
+      return true;
+    }
+    line.entryColumn = next - lineStart;
+  }
+
+  // quoted keys are left to libyaml, a quoted entry must be a lone scalar
+  if (isQuote(*next)) {
+    return readScalar(next, pEnd, line.value) && endsLine(next, pEnd);
+  }
+
+  if (!startsPlain(next, pEnd)) {
+    return false;
+  }
+
+  const char* start = next;
+  bool key;
+  next = scanPlain(next, pEnd, key);
+  if (!key) {
+    line.value = { trimmed(start, next), true, true };
+    return true;
+  }
+
+  if (next[-1] == ' ' || static_cast<size_t>(next - start) > MAX_KEY_LENGTH) {
+    return false;
+  }
+  line.hasKey = true;
+  line.key = std::string_view(start, next - start);
+  // merge keys are resolved while building from libyaml events
+  if (line.key == "<<") {
+    return false;
+  }
+
+  next = skipSpaces(next + 1, pEnd);
+  if (next == pEnd || *next == '#') {
+    return true;
+  }
+
+  return readScalar(next, pEnd, line.value) && endsLine(next, pEnd);
+}
+
+bool BlockScanner::readScalar(const char*& pCursor,
+                              const char* pEnd,
+                              Token& pOut)
+{
+  char quote = *pCursor;
+  if (isQuote(quote)) {
+    const char* close = quote == '\''
+                          ? ByteScan::findAny<'\''>(pCursor + 1, pEnd)
+                          : ByteScan::findAny<'"', '\\'>(pCursor + 1, pEnd);
+    // multi-line, escaped or unterminated
+    if (close == pEnd || *close == '\\' ||
+        (quote == '\'' && close + 1 != pEnd && close[1] == '\'')) {
+      return false;
+    }
+
+    pOut = { std::string_view(pCursor + 1, close - pCursor - 1), false, true };
+    pCursor = close + 1;
+    return true;
+  }
+
+  if (!startsPlain(pCursor, pEnd)) {
+    return false;
+  }
+
+  // a second ": " on the line is an error libyaml has to report
+  const char* start = pCursor;
+  bool key;
+  pCursor = scanPlain(pCursor, pEnd, key);
+  if (key) {
+    return false;
+  }
+
+  pOut = { trimmed(start, pCursor), true, true };
+  return true;
+}
+
+bool BlockScanner::parseNode(Doc* pNode)
+{
+  if (line.dash) {
+    return parseSequence(pNode, line.indent);
+  }
+  if (line.hasKey) {
+    return parseMapping(pNode, line.indent);
+  }
+
+  // a scalar on its own line, either multi-line or a whole document
+  return false;
+}
+
+bool BlockScanner::parseMapping(Doc* pNode, size_t pIndent)
+{
+  pNode->type = Doc::MAPPING;
+  while (hasLine && line.indent >= pIndent) {
+    if (line.indent != pIndent || line.dash || !line.hasKey) {
+      return false;
+    }
+
+    Doc* child = pNode->appendChild(line.key);
+    if (line.value.present) {
+      setScalar(child, line.value);
+      if (!advance()) {
+        return false;
+      }
+      continue;
+    }
+
+    Token empty;
+    if (!advance()) {
+      return false;
+    }
+    if (hasLine && line.indent > pIndent) {
+      if (!parseNode(child)) {
+        return false;
+      }
+    } else if (hasLine && line.indent == pIndent && line.dash) {
+      // sequences may sit at the indentation of their key
+      if (!parseSequence(child, pIndent)) {
+        return false;
+      }
+    } else {
+      setScalar(child, empty);
+    }
+  }
+
+  finish(pNode);
+  return true;
+}
+
+bool BlockScanner::parseSequence(Doc* pNode, size_t pIndent)
+{
+  pNode->type = Doc::SEQUENCE;
+  while (hasLine && line.indent >= pIndent) {
+    if (line.indent != pIndent) {
+      return false;
+    }
+    if (!line.dash) {
+      break;
+    }
+
+    Doc* item = pNode->addSequenceItem();
+    if (line.hasKey) {
+      // "- key: value" opens a mapping at the column of the key
+      line.indent = line.entryColumn;
+      line.dash = false;
+      if (!parseMapping(item, line.entryColumn)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (line.value.present) {
+      setScalar(item, line.value);
+      if (!advance()) {
+        return false;
+      }
+      continue;
+    }
+
+    Token empty;
+    if (!advance()) {
+      return false;
+    }
+    if (hasLine && line.indent > pIndent) {
+      if (!parseNode(item)) {
+        return false;
+      }
+    } else {
+      setScalar(item, empty);
+    }
+  }
+
+  finish(pNode);
+  return true;
+}
+
+void BlockScanner::setScalar(Doc* pNode, const Token& pToken)
+{
+  pNode->type = Doc::SCALAR;
+  pNode->setScalar(pToken.text, pToken.plain, std::string_view());
+}
+
+void BlockScanner::finish(Doc* pNode)
+{
+  if (pNode->childCount >= ChildIndex::THRESHOLD) {
+    pNode->buildIndex();
+  }
+}
+
+}
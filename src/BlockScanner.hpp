@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Doc.hpp"
+
+#include <string_view>
+
+namespace YAML {
+
+// Builds documents written in the block subset of YAML that configuration
+// files are made of, without going through libyaml: block mappings with plain
+// keys, block sequences, single line plain scalars, quoted scalars without
+// escapes and comments. Lines and indicators are located with the bulk
+// searches of ByteScan.hpp.
+//
+// Anything else (flow collections, anchors, merge keys, tags, block or
+// multi-line scalars, document markers, tabs, ...) makes build() give up, and
+// the caller parses the input again with libyaml, which also reports syntax
+// errors.
+// Scalars are kept as views into the source, which must outlive the document.
+class BlockScanner
+{
+public:
+  // pRoot must be empty, it is left half built when false is returned
+  static bool build(std::string_view pSource, Doc& pRoot);
+
+private:
+  struct Token
+  {
+    std::string_view text;
+    bool plain = true;
+    bool present = false;
+  };
+
+  // a content line, blank and comment lines are skipped
+  struct Line
+  {
+    size_t indent;
+    bool dash;
+    // where the entry after "- " starts
+    size_t entryColumn;
+    bool hasKey;
+    std::string_view key;
+    Token value;
+  };
+
+  BlockScanner(std::string_view pSource);
+
+  bool validate() const;
+
+  // loads the next content line, false when it uses an unsupported construct
+  bool advance();
+  bool analyze(const char* pBegin, const char* pEnd);
+  bool readScalar(const char*& pCursor, const char* pEnd, Token& pOut);
+
+  bool parseNode(Doc* pNode);
+  bool parseMapping(Doc* pNode, size_t pIndent);
+  bool parseSequence(Doc* pNode, size_t pIndent);
+
+  static void setScalar(Doc* pNode, const Token& pToken);
+  static void finish(Doc* pNode);
+
+private:
+  std::string_view source;
+  const char* cursor;
+  const char* lineStart;
+  bool hasLine = false;
+  Line line;
+};
+
+}
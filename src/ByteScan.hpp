@@ -0,0 +1,152 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YAML_DOC_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define YAML_DOC_SCAN_SSE2 1
+#endif
+
+namespace YAML {
+
+// Bulk byte searches for the block scanner, a register wide block at a time
+// with AVX2 or SSE2 when the target has them and a byte loop otherwise. The
+// instruction set is chosen at compile time, build with -mavx2 (or
+// -march=native) to get the wider one.
+namespace ByteScan {
+
+#if defined(YAML_DOC_SCAN_AVX2)
+using Block = __m256i;
+constexpr int BLOCK_SIZE = 32;
+
+inline Block load(const char* pData)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+}
+
+inline Block equal(Block pBlock, char pChar)
+{
+  return _mm256_cmpeq_epi8(pBlock, _mm256_set1_epi8(pChar));
+}
+
+inline Block any(Block pA, Block pB)
+{
+  return _mm256_or_si256(pA, pB);
+}
+
+// signed compare, bytes from 0x80 up count as below
+inline Block below(Block pBlock, char pChar)
+{
+  return _mm256_cmpgt_epi8(_mm256_set1_epi8(pChar), pBlock);
+}
+
+inline Block without(Block pA, Block pB)
+{
+  return _mm256_andnot_si256(pB, pA);
+}
+
+inline uint32_t mask(Block pBlock)
+{
+  return static_cast<uint32_t>(_mm256_movemask_epi8(pBlock));
+}
+#elif defined(YAML_DOC_SCAN_SSE2)
+using Block = __m128i;
+constexpr int BLOCK_SIZE = 16;
+
+inline Block load(const char* pData)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+}
+
+inline Block equal(Block pBlock, char pChar)
+{
+  return _mm_cmpeq_epi8(pBlock, _mm_set1_epi8(pChar));
+}
+
+inline Block any(Block pA, Block pB)
+{
+  return _mm_or_si128(pA, pB);
+}
+
+inline Block below(Block pBlock, char pChar)
+{
+  return _mm_cmplt_epi8(pBlock, _mm_set1_epi8(pChar));
+}
+
+inline Block without(Block pA, Block pB)
+{
+  return _mm_andnot_si128(pB, pA);
+}
+
+inline uint32_t mask(Block pBlock)
+{
+  return static_cast<uint32_t>(_mm_movemask_epi8(pBlock));
+}
+#endif
+
+#if defined(YAML_DOC_SCAN_AVX2) || defined(YAML_DOC_SCAN_SSE2)
+template<char First, char... Rest>
+inline Block equalAny(Block pBlock)
+{
+  if constexpr (sizeof...(Rest) == 0) {
+    return equal(pBlock, First);
+  } else {
+    return any(equal(pBlock, First), equalAny<Rest...>(pBlock));
+  }
+}
+#endif
+
+// first byte in [pBegin, pEnd) equal to one of Chars, or pEnd
+template<char... Chars>
+inline const char* findAny(const char* pBegin, const char* pEnd)
+{
+#if defined(YAML_DOC_SCAN_AVX2) || defined(YAML_DOC_SCAN_SSE2)
+  for (; pEnd - pBegin >= BLOCK_SIZE; pBegin += BLOCK_SIZE) {
+    Block block = load(pBegin);
+    uint32_t found = mask(equalAny<Chars...>(block));
+    if (found != 0) {
+      return pBegin + std::countr_zero(found);
+    }
+  }
+#endif
+
+  for (; pBegin != pEnd; pBegin++) {
+    if (((*pBegin == Chars) || ...)) {
+      return pBegin;
+    }
+  }
+  return pEnd;
+}
+
+// first byte in [pBegin, pEnd) that isn't printable ASCII or a line feed, or
+// pEnd
+inline const char* findIrregular(const char* pBegin, const char* pEnd)
+{
+#if defined(YAML_DOC_SCAN_AVX2) || defined(YAML_DOC_SCAN_SSE2)
+  for (; pEnd - pBegin >= BLOCK_SIZE; pBegin += BLOCK_SIZE) {
+    Block block = load(pBegin);
+    Block irregular = without(any(below(block, 0x20), equal(block, 0x7F)),
+                              equal(block, '\n'));
+    uint32_t found = mask(irregular);
+    if (found != 0) {
+      return pBegin + std::countr_zero(found);
+    }
+  }
+#endif
+
+  for (; pBegin != pEnd; pBegin++) {
+    unsigned char byte = static_cast<unsigned char>(*pBegin);
+    if ((byte < 0x20 || byte >= 0x7F) && byte != '\n') {
+      return pBegin;
+    }
+  }
+  return pEnd;
+}
+
+}
+
+}
@@ -0,0 +1,52 @@
+#include "ChildIndex.hpp"
+
+#include <bit>
+
+namespace YAML {
+ChildIndex::ChildIndex(const allocator_type& pAllocator)
+  : slots(pAllocator)
+{
+}
+
+ChildIndex::ChildIndex(const ChildIndex& pOther,
+                       const allocator_type& pAllocator)
+  : slots(pOther.slots, pAllocator)
+  , count(pOther.count)
+{
+}
+
+ChildIndex::ChildIndex(ChildIndex&& pOther, const allocator_type& pAllocator)
+  : slots(std::move(pOther.slots), pAllocator)
+  , count(pOther.count)
+{
+}
+
+void ChildIndex::reserve(uint32_t pCount)
+{
+  size_t capacity = std::bit_ceil(size_t(pCount) * 2);
+  if (capacity <= slots.size()) {
+    return;
+  }
+
+  std::pmr::vector<Slot> previous = std::move(slots);
+  slots.assign(capacity, { 0, NOT_FOUND });
+
+  size_t mask = slots.size() - 1;
+  for (const Slot& slot : previous) {
+    if (slot.node == NOT_FOUND) {
+      continue;
+    }
+
+    size_t i = slot.hash & mask;
+    while (slots[i].node != NOT_FOUND) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+  }
+}
+
+void ChildIndex::grow()
+{
+  reserve(slots.empty() ? THRESHOLD : static_cast<uint32_t>(slots.size()));
+}
+}
@@ -0,0 +1,91 @@
+#include "ColumnSet.hpp"
+
+#include <bit>
+
+namespace YAML {
+size_t ColumnBase::countValid() const
+{
+  size_t valid = 0;
+  for (uint64_t word : validity) {
+    valid += std::popcount(word);
+  }
+  return valid;
+}
+
+void ColumnBase::grow(size_t pCount)
+{
+  rows += pCount;
+  validity.resize((rows + 63) / 64, 0);
+}
+
+void ColumnSet::extract(const Doc& pSequence)
+{
+  const Doc* holder = pSequence.content();
+  for (std::unique_ptr<ColumnBase>& column : columns) {
+    column->clear(holder->childCount);
+  }
+  rows = 0;
+
+  if (columns.empty() || holder->childCount == 0) {
+    return;
+  }
+
+  // the key id of each field, NOT_FOUND when no node has that name and
+  // PATH for the dotted ones
+  static constexpr uint32_t PATH = KeyTable::NOT_FOUND - 1;
+  const KeyTable& keys = pSequence.arena->getKeys();
+  std::vector<uint32_t> ids;
+  size_t scanned = 0;
+  for (const std::unique_ptr<ColumnBase>& column : columns) {
+    std::string_view field = column->field;
+    if (field.find('.') != std::string_view::npos) {
+      ids.push_back(PATH);
+      continue;
+    }
+    ids.push_back(keys.find(field, hashKey(field)));
+    scanned += ids.back() != KeyTable::NOT_FOUND;
+  }
+
+  // the field nodes of a block of rows, column after column
+  size_t width = columns.size();
+  std::vector<const Doc*> block(BLOCK * width);
+  size_t row = 0;
+  auto flush = [&]() {
+    for (size_t i = 0; i < width; i++) {
+      columns[i]->append(block.data() + i * BLOCK, row);
+    }
+    rows += row;
+    row = 0;
+  };
+
+  for (const Doc& element : holder->children()) {
+    for (size_t i = 0; i < width; i++) {
+      block[i * BLOCK + row] = ids[i] == PATH
+                                 ? element.lookupNode(columns[i]->field)
+                                 : nullptr;
+    }
+
+    // one pass over the children for all the fields, the first child with
+    // a name wins like in a lookup
+    const Doc* fields = element.content();
+    size_t found = 0;
+    for (uint32_t child = fields->firstChild;
+         child != DocArena::NO_NODE && found < scanned;
+         child = element.node(child)->nextSibling) {
+      const Doc* node = element.node(child);
+      for (size_t i = 0; i < width; i++) {
+        const Doc*& slot = block[i * BLOCK + row];
+        if (ids[i] == node->key && slot == nullptr) {
+          slot = node;
+          found++;
+        }
+      }
+    }
+
+    if (++row == BLOCK) {
+      flush();
+    }
+  }
+  flush();
+}
+}
@@ -1,290 +1,1107 @@
 #include "Doc.hpp"
+#include "BlockScanner.hpp"
+#include "DocBuilder.hpp"
+#include "DocWriter.hpp"
+#include "EventReader.hpp"
+#include "MappedFile.hpp"
+#include "Snapshot.hpp"
 
 #include "exceptions/DocFileException.hpp"
 #include "exceptions/DocNodeException.hpp"
 #include "exceptions/DocParserException.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <istream>
 #include <ostream>
 #include <string>
-#include <yaml.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace YAML {
+namespace {
+size_t countSegments(std::string_view pPath)
+{
+  return pPath.empty() ? 0 : std::count(pPath.begin(), pPath.end(), '.') + 1;
+}
+
+// a lookup of a path of pSegments segments that searched pCompared of them
+void countLookup(LookupStats& pStats,
+                 size_t pSegments,
+                 size_t pCompared,
+                 bool pFound)
+{
+  (pFound ? pStats.hits : pStats.misses)
+    .fetch_add(1, std::memory_order_relaxed);
+  pStats.segments.fetch_add(pSegments, std::memory_order_relaxed);
+  pStats.segmentsCompared.fetch_add(pCompared, std::memory_order_relaxed);
+}
+
+// a lookup of every path of pPaths, where a segment they share counts as
+// compared once, reached or not
+void countLookups(LookupStats& pStats, const PathSet& pPaths, size_t pFound)
+{
+  pStats.hits.fetch_add(pFound, std::memory_order_relaxed);
+  pStats.misses.fetch_add(pPaths.size() - pFound, std::memory_order_relaxed);
+  pStats.segments.fetch_add(pPaths.segmentCount(), std::memory_order_relaxed);
+  pStats.segmentsCompared.fetch_add(pPaths.entryCount(),
+                                    std::memory_order_relaxed);
+}
+}
+
 Doc Doc::parseFile(const std::string& pPath)
 {
-  Doc doc;
-  doc.name = "root";
+  return parseFile(pPath, ParseOptions());
+}
 
-  FILE* yamlFile = fopen(pPath.c_str(), "r");
-  if (yamlFile == NULL) {
-    throw DocFileException("Could not open file", pPath);
+Doc Doc::parseFile(const std::string& pPath, const ParseOptions& pOptions)
+{
+  if (!pOptions.snapshotCache.empty()) {
+    return Snapshot::parseCached(pPath, pOptions);
   }
 
-  yaml_parser_t parser;
-  yaml_event_t event;
+  std::shared_ptr<MappedFile> file =
+    MappedFile::open(pPath, pOptions.mapFile);
+  std::string_view bytes = file->getBytes();
 
-  if (!yaml_parser_initialize(&parser)) {
-    yaml_event_delete(&event);
-    yaml_parser_delete(&parser);
-    fclose(yamlFile);
-    throw DocParserException("Could not initialize yaml parser");
-  }
+  // the scan is a single forward pass, lookups afterwards are random
+  Doc doc = parseBuffer(file, bytes, pOptions);
+  file->adviseSequential(false);
+  return doc;
+}
 
-  yaml_parser_set_input_file(&parser, yamlFile);
-  processYamlEvents(parser, event, doc);
+Doc Doc::parseString(const std::string& pString)
+{
+  return parseString(pString, ParseOptions());
+}
 
-  yaml_event_delete(&event);
-  yaml_parser_delete(&parser);
-  fclose(yamlFile);
+Doc Doc::parseString(const std::string& pString, const ParseOptions& pOptions)
+{
+  // the copy comes from the same resource as the nodes viewing into it
+  std::pmr::polymorphic_allocator<> allocator(
+    pOptions.memory ? pOptions.memory : std::pmr::get_default_resource());
+  auto content = std::allocate_shared<std::pmr::string>(allocator, pString);
+  std::string_view bytes = *content;
+  return parseBuffer(std::move(content), bytes, pOptions);
+}
 
-  return std::move(doc);
+Doc Doc::parseFile(const std::string& pPath,
+                   std::pmr::memory_resource* pMemory)
+{
+  ParseOptions options;
+  options.memory = pMemory;
+  return parseFile(pPath, options);
 }
 
-Doc Doc::parseString(const std::string& pString)
+Doc Doc::parseString(const std::string& pString,
+                     std::pmr::memory_resource* pMemory)
+{
+  ParseOptions options;
+  options.memory = pMemory;
+  return parseString(pString, options);
+}
+
+Doc Doc::parseString(std::string&& pString)
 {
+  auto content = std::make_shared<std::string>(std::move(pString));
+  std::string_view bytes = *content;
+  return parseBuffer(std::move(content), bytes, ParseOptions());
+}
+
+Doc Doc::parseFile(const std::string& pPath, const Selection& pSelection)
+{
+  // the selected values are copied, the mapping doesn't outlive the parse
+  std::shared_ptr<MappedFile> file = MappedFile::open(pPath, true);
+  return parseBuffer(nullptr, file->getBytes(), ParseOptions(), &pSelection);
+}
+
+Doc Doc::parseString(std::string_view pString, const Selection& pSelection)
+{
+  return parseBuffer(nullptr, pString, ParseOptions(), &pSelection);
+}
+
+Doc Doc::parseBuffer(std::shared_ptr<const void> pOwner,
+                     std::string_view pBytes,
+                     const ParseOptions& pOptions,
+                     const Selection* pSelection)
+{
+  using Clock = std::chrono::steady_clock;
+  ParseStats* stats = pOptions.stats;
+  Clock::time_point start;
+  if (stats) {
+    *stats = ParseStats();
+    stats->bytes = pBytes.size();
+    start = Clock::now();
+  }
+
+  // the block scanner keeps every scalar as a view, so it can't serve a
+  // selection which copies them. Inputs it gives up on are parsed again from
+  // the start by libyaml.
+  if (pOptions.fastScan && pSelection == nullptr) {
+    Doc doc;
+    doc.initRoot(pOwner, pBytes, pOptions.memory);
+    bool built = BlockScanner::build(pBytes, doc);
+    if (stats) {
+      stats->fastScanSeconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    if (built) {
+      doc.arena->setSource(pBytes);
+      if (stats) {
+        stats->fastScanned = true;
+        doc.collectStats(*stats);
+        stats->totalSeconds =
+          std::chrono::duration<double>(Clock::now() - start).count();
+      }
+      return doc;
+    }
+  }
+
   Doc doc;
-  doc.name = "root";
+  doc.initRoot(std::move(pOwner), pBytes, pOptions.memory);
+
+  DocBuilder builder(doc, pSelection);
+  EventReader reader(builder);
+  reader.setStats(stats);
+  reader.readString(pBytes);
+  if (pSelection == nullptr) {
+    doc.arena->setSource(pBytes);
+  }
 
-  yaml_parser_t parser;
-  yaml_event_t event;
+  if (stats) {
+    doc.collectStats(*stats);
+    stats->totalSeconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return doc;
+}
+
+void Doc::parseFile(const std::string& pPath, DocVisitor& pVisitor)
+{
+  FILE* yamlFile = fopen(pPath.c_str(), "rb");
+  if (yamlFile == NULL) {
+    throw DocFileException("Could not open file", pPath);
+  }
 
-  if (!yaml_parser_initialize(&parser)) {
-    yaml_event_delete(&event);
-    yaml_parser_delete(&parser);
-    throw DocParserException("Could not initialize yaml parser");
+  try {
+    EventReader(pVisitor).readFile(yamlFile);
+  } catch (...) {
+    fclose(yamlFile);
+    throw;
   }
 
-  yaml_parser_set_input_string(
-    &parser, (unsigned const char*)pString.c_str(), (size_t)pString.length());
-  processYamlEvents(parser, event, doc);
+  fclose(yamlFile);
+}
+
+void Doc::parseString(std::string_view pString, DocVisitor& pVisitor)
+{
+  EventReader(pVisitor).readString(pString);
+}
 
-  yaml_event_delete(&event);
-  yaml_parser_delete(&parser);
+void Doc::parseInput(const Reader& pRead, DocVisitor& pVisitor)
+{
+  EventReader(pVisitor).readInput(pRead);
+}
 
-  return std::move(doc);
+void Doc::parseInput(std::istream& pInput, DocVisitor& pVisitor)
+{
+  EventReader(pVisitor).readInput(streamReader(pInput));
+}
+
+Doc::Reader Doc::streamReader(std::istream& pInput)
+{
+  return [&pInput](char* pBuffer, size_t pSize) -> size_t {
+    pInput.read(pBuffer, static_cast<std::streamsize>(pSize));
+    if (pInput.bad()) {
+      throw DocParserException("Could not read the input stream");
+    }
+    return static_cast<size_t>(pInput.gcount());
+  };
+}
+
+void Doc::initRoot(std::shared_ptr<const void> pOwner,
+                   std::string_view pBytes,
+                   std::pmr::memory_resource* pMemory)
+{
+  ensureArena(pMemory);
+  key = KeyTable::ROOT;
+  if (pOwner) {
+    arena->retain(std::move(pOwner), pBytes);
+  }
 }
 
 Doc::Doc() {}
 
-Doc::Doc(Doc* pParent)
+Doc::Doc(std::pmr::memory_resource* pMemory)
 {
-  parent = pParent;
+  ensureArena(pMemory);
 }
 
 Doc::Doc(const Doc& pOther)
 {
-  type = pOther.type;
-  name = pOther.name;
-  value = pOther.value;
-  parent = pOther.parent;
-  children = pOther.children;
+  // expanding aliases may throw, the destructor won't release the arena then
+  try {
+    copyFrom(pOther);
+  } catch (...) {
+    DocArena::destroy(arena);
+    throw;
+  }
 }
 
 Doc& Doc::operator=(const Doc& pOther)
+{
+  return assign(pOther, false);
+}
+
+Doc::Doc(Doc&& pOther) noexcept
+{
+  // nodes living in another document's arena can't be stolen, only copied,
+  // keeping their aliases shared so that no expansion can fail
+  if (!pOther.ownsArena()) {
+    copyFrom(pOther, true);
+    return;
+  }
+
+  takeFrom(pOther);
+}
+
+Doc& Doc::operator=(Doc&& pOther) noexcept
 {
   if (this == &pOther) {
     return *this;
   }
 
-  type = pOther.type;
-  name = pOther.name;
-  value = pOther.value;
-  parent = pOther.parent;
-  children = pOther.children;
+  // nodes can't change resource either, they are copied into this one
+  if (!ownsArena() || !pOther.ownsArena() ||
+      (arena && pOther.arena &&
+       arena->getMemory() != pOther.arena->getMemory())) {
+    return assign(pOther, true);
+  }
+
+  DocArena::destroy(arena);
+  takeFrom(pOther);
 
   return *this;
 }
 
-Doc::Doc(Doc&& pOther) noexcept
+void Doc::takeFrom(Doc& pOther)
 {
-  type = std::move(pOther.type);
-  name = std::move(pOther.name);
-  value = std::move(pOther.value);
-  parent = pOther.parent;
-  children = std::move(pOther.children);
+  type = pOther.type;
+  flags = pOther.flags;
+  kind = pOther.kind;
+  number = pOther.number;
+  key = pOther.key;
+  value = pOther.value;
 
-  pOther.parent = nullptr;
+  arena = pOther.arena;
+  firstChild = pOther.firstChild;
+  lastChild = pOther.lastChild;
+  childCount = pOther.childCount;
+  childIndex = pOther.childIndex;
+  if (arena) {
+    arena->setRoot(this);
+  }
+
+  pOther.arena = nullptr;
+  pOther.firstChild = DocArena::NO_NODE;
+  pOther.lastChild = DocArena::NO_NODE;
+  pOther.childCount = 0;
+  pOther.childIndex = DocArena::NO_NODE;
 }
 
-void Doc::processYamlEvents(yaml_parser_t& pParser,
-                            yaml_event_t& pEvent,
-                            Doc& pDoc)
+Doc& Doc::assign(const Doc& pOther, bool pSharing)
 {
-  Doc* currentDoc = &pDoc;
-  do {
-    if (!yaml_parser_parse(&pParser, &pEvent)) {
-      throw DocParserException(
-        "An error occured while parsing the document : " +
-        std::string(pParser.problem));
-    }
+  if (this == &pOther) {
+    return *this;
+  }
 
-    if (currentDoc == nullptr) {
-      throw DocParserException("unexpected null node");
-    }
+  // copy first so assigning an ancestor or a descendant stays well defined
+  if (ownsArena()) {
+    Doc copy(getMemoryResource());
+    copy.copyFrom(pOther, pSharing);
+    return *this = std::move(copy);
+  }
 
-    switch (pEvent.type) {
-      case YAML_MAPPING_START_EVENT:
-        if (currentDoc->type == SEQUENCE) {
-          currentDoc = currentDoc->addSequenceItem();
-        }
-        currentDoc->type = MAPPING;
-        break;
+  Doc copy;
+  copy.copyFrom(pOther, pSharing);
+  // the tree no longer matches its input, see reloadString()
+  arena->setSource({});
+  detachChildren();
+  if (copy.arena) {
+    arena->retainAll(*copy.arena);
+  }
+  key = arena->internKey(copy.getNameView());
+  copyContent(copy);
+  if (pSharing) {
+    shareChildren(copy);
+  } else {
+    copyChildren(copy);
+  }
 
-      case YAML_SEQUENCE_START_EVENT:
-        if (currentDoc->type == SEQUENCE) {
-          currentDoc = currentDoc->addSequenceItem();
-        }
-        currentDoc->type = SEQUENCE;
-        break;
+  return *this;
+}
 
-      case YAML_MAPPING_END_EVENT:
-      case YAML_SEQUENCE_END_EVENT:
-        if (currentDoc->parent) {
-          currentDoc = currentDoc->parent;
-        }
-        break;
-
-      case YAML_ALIAS_EVENT:
-        break;
-
-      case YAML_SCALAR_EVENT: {
-        std::string scalarValue((char*)pEvent.data.scalar.value);
-        if (currentDoc->type == SCALAR) {
-          currentDoc->value = scalarValue;
-          currentDoc = currentDoc->parent;
-        } else if (currentDoc->type == SEQUENCE) {
-          Doc* item = currentDoc->addSequenceItem();
-          item->value = scalarValue;
-        } else {
-          currentDoc = currentDoc->createChild();
-          currentDoc->name = scalarValue;
-          currentDoc->type = SCALAR;
-        }
-      } break;
-      default:
-        break;
-    }
+void Doc::copyFrom(const Doc& pOther, bool pSharing)
+{
+  if (pOther.arena) {
+    ensureArena(pOther.arena->getMemory())->retainAll(*pOther.arena);
+    key = arena->internKey(pOther.getNameView());
+  } else {
+    key = KeyTable::EMPTY;
+  }
+  copyContent(pOther);
+  if (pSharing) {
+    shareChildren(pOther);
+  } else {
+    copyChildren(pOther);
+  }
+}
 
-    if (pEvent.type != YAML_STREAM_END_EVENT)
-      yaml_event_delete(&pEvent);
+void Doc::copyContent(const Doc& pOther)
+{
+  type = pOther.type;
+  flags = 0;
+  kind = pOther.kind;
+  number = pOther.number;
+  value = arena ? arena->adoptString(pOther.value) : pOther.value;
+}
 
-  } while (pEvent.type != YAML_STREAM_END_EVENT);
+Doc::~Doc()
+{
+  if (ownsArena()) {
+    DocArena::destroy(arena);
+  }
 }
 
 Doc* Doc::addChild(Doc pChild)
 {
-  children.push_back(std::move(pChild));
-  return &children.back();
+  ensureArena()->setSource({});
+  unshare();
+  if (pChild.arena) {
+    arena->retainAll(*pChild.arena);
+  }
+
+  Doc* child = appendChild(pChild.getNameView());
+  child->copyContent(pChild);
+  child->copyChildren(pChild);
+  return child;
+}
+
+void Doc::setScalar(std::string_view pValue, bool pPlain, std::string_view pTag)
+{
+  value = pValue;
+  if (pPlain || !pTag.empty()) {
+    kind = Scalar::classify(pValue, pTag, number.integer, number.real);
+  } else {
+    kind = Scalar::STRING;
+  }
+}
+
+DocArena* Doc::ensureArena(std::pmr::memory_resource* pMemory)
+{
+  if (arena == nullptr) {
+    arena = DocArena::create(this, pMemory);
+  }
+
+  return arena;
+}
+
+std::pmr::memory_resource* Doc::getMemoryResource() const
+{
+  return arena ? arena->getMemory() : std::pmr::get_default_resource();
 }
 
 Doc* Doc::createChild()
 {
-  children.emplace_back(this);
-  return &children.back();
+  ensureArena()->setSource({});
+  unshare();
+  return appendChild(KeyTable::EMPTY);
 }
 
 Doc* Doc::addSequenceItem()
 {
-  Doc* child = createChild();
-  child->name = std::to_string(children.size() - 1);
+  ensureArena()->setSource({});
+  unshare();
+  return appendChild(arena->itemKey(childCount));
+}
+
+Doc* Doc::appendChild(std::string_view pName)
+{
+  return appendChild(ensureArena()->internKey(pName));
+}
+
+Doc* Doc::appendChild(uint32_t pKey)
+{
+  ensureArena();
+
+  uint32_t childNode = arena->allocate();
+  Doc* child = node(childNode);
+  child->arena = arena;
+  child->index = childNode;
+  child->parent = index;
+  child->key = pKey;
+
+  if (lastChild == DocArena::NO_NODE) {
+    firstChild = childNode;
+  } else {
+    node(lastChild)->nextSibling = childNode;
+  }
+  lastChild = childNode;
+  childCount++;
+
+  if (childIndex != DocArena::NO_NODE) {
+    uint32_t hash = KeyTable::hashId(pKey);
+    arena->getIndex(childIndex).insert(hash, childNode, [&](uint32_t pOther) {
+      return node(pOther)->key == pKey;
+    });
+  }
+
   return child;
 }
 
-std::string Doc::toString(int pDepth) const
+void Doc::makeAlias(const Doc& pTarget)
 {
-  std::string str = "";
+  type = pTarget.type;
+  kind = pTarget.kind;
+  number = pTarget.number;
+  value = pTarget.value;
+  alias = pTarget.content()->index;
+}
 
-  if (pDepth > 0) {
-    for (int i = 0; i < pDepth; i++) {
-      if (i == 0) {
-        str += "|";
-      } else {
-        str += "--";
-      }
+void Doc::unshare()
+{
+  if (!isAlias()) {
+    return;
+  }
 
-      if (i == pDepth - 1) {
-        str += " ";
-      }
+  const Doc* shared = content();
+  alias = DocArena::NO_NODE;
+  size_t budget = MAX_ALIAS_EXPANSION;
+  copyChildren(*shared, true, budget);
+}
+
+void Doc::unlinkChild(Doc* pChild)
+{
+  uint32_t* link = &firstChild;
+  uint32_t previous = DocArena::NO_NODE;
+  while (*link != pChild->index) {
+    previous = *link;
+    link = &node(*link)->nextSibling;
+  }
+
+  *link = pChild->nextSibling;
+  if (lastChild == pChild->index) {
+    lastChild = previous;
+  }
+  pChild->nextSibling = DocArena::NO_NODE;
+  childCount--;
+
+  // the index may hold the child, rebuild it without
+  if (childIndex != DocArena::NO_NODE) {
+    childIndex = DocArena::NO_NODE;
+    if (childCount >= ChildIndex::THRESHOLD) {
+      buildIndex();
     }
   }
+}
 
-  str += name;
+void Doc::buildIndex()
+{
+  uint32_t created = ensureArena()->createIndex();
+  ChildIndex& table = arena->getIndex(created);
+  table.reserve(childCount);
+  for (uint32_t i = firstChild; i != DocArena::NO_NODE;
+       i = node(i)->nextSibling) {
+    uint32_t key = node(i)->key;
+    table.insert(KeyTable::hashId(key), i, [&](uint32_t pOther) {
+      return node(pOther)->key == key;
+    });
+  }
+  childIndex = created;
+}
 
-  if (children.size() == 0) {
-    str += " -> " + value;
+Doc* Doc::findChild(std::string_view pName)
+{
+  return findChild(pName, hashKey(pName));
+}
+
+Doc* Doc::findChild(std::string_view pName, uint64_t pHash)
+{
+  if (isAlias()) {
+    return content()->findChild(pName, pHash);
   }
 
-  str += "\n";
+  // no node at all has a name missing from the key table, children are
+  // compared by key id from there on
+  if (firstChild == DocArena::NO_NODE) {
+    return nullptr;
+  }
+  uint32_t wanted = arena->getKeys().find(pName, pHash);
+  if (wanted == KeyTable::NOT_FOUND) {
+    return nullptr;
+  }
+  return findChild(wanted);
+}
 
-  for (int i = 0; i < children.size(); i++) {
-    str += children[i].toString(pDepth + 1);
+Doc* Doc::findChild(uint32_t pKey)
+{
+  if (isAlias()) {
+    return content()->findChild(pKey);
   }
 
-  return str;
+  if (childIndex == DocArena::NO_NODE) {
+    if (childCount < ChildIndex::THRESHOLD) {
+      return scanChildren(pKey);
+    }
+    buildIndex();
+  }
+
+  uint32_t found = arena->getIndex(childIndex).find(
+    KeyTable::hashId(pKey),
+    [&](uint32_t pChild) { return node(pChild)->key == pKey; });
+  return found == ChildIndex::NOT_FOUND ? nullptr : node(found);
 }
 
-std::string Doc::toString() const
+const Doc* Doc::lookupChild(std::string_view pName) const
 {
-  return toString(0);
+  return lookupChild(pName, hashKey(pName));
 }
 
-Doc* Doc::getNode(const std::string& pPath)
+const Doc* Doc::lookupChild(std::string_view pName, uint64_t pHash) const
 {
-  if (pPath.empty()) {
-    return this;
+  const Doc* holder = content();
+  if (holder->firstChild == DocArena::NO_NODE) {
+    return nullptr;
   }
+  uint32_t wanted = arena->getKeys().find(pName, pHash);
+  if (wanted == KeyTable::NOT_FOUND) {
+    return nullptr;
+  }
+  return lookupChild(wanted);
+}
+
+const Doc* Doc::lookupChild(uint32_t pKey) const
+{
+  const Doc* holder = content();
+  if (holder->childIndex == DocArena::NO_NODE) {
+    return holder->scanChildren(pKey);
+  }
+
+  uint32_t found = arena->getIndex(holder->childIndex).find(
+    KeyTable::hashId(pKey),
+    [&](uint32_t pChild) { return node(pChild)->key == pKey; });
+  return found == ChildIndex::NOT_FOUND ? nullptr : node(found);
+}
 
-  std::stringstream ss(pPath);
-  std::string token;
+Doc* Doc::scanChildren(uint32_t pKey) const
+{
+  for (uint32_t i = firstChild; i != DocArena::NO_NODE;
+       i = node(i)->nextSibling) {
+    Doc* child = node(i);
+    if (child->key == pKey) {
+      return child;
+    }
+  }
+
+  return nullptr;
+}
+
+Doc* Doc::findNode(std::string_view pPath)
+{
   Doc* currentDoc = this;
+  if (pPath.empty()) {
+    if (LookupStats* stats = lookupStats()) {
+      countLookup(*stats, 0, 0, true);
+    }
+    return currentDoc;
+  }
+
+  size_t start = 0;
+  while (true) {
+    size_t end = pPath.find('.', start);
+    if (end == std::string_view::npos) {
+      end = pPath.size();
+    }
 
-  while (std::getline(ss, token, '.')) {
-    bool found = false;
-    for (int i = 0; i < currentDoc->children.size(); i++) {
-      if (currentDoc->children[i].name == token) {
-        currentDoc = &currentDoc->children[i];
-        found = true;
-        break;
+    currentDoc = currentDoc->findChild(pPath.substr(start, end - start));
+    if (currentDoc == nullptr || end == pPath.size()) {
+      if (LookupStats* stats = lookupStats()) {
+        countLookup(*stats,
+                    countSegments(pPath),
+                    countSegments(pPath.substr(0, end)),
+                    currentDoc != nullptr);
       }
+      return currentDoc;
     }
+    start = end + 1;
+  }
+}
 
-    if (!found) {
-      currentDoc = nullptr;
-      throw DocNodeException("Node " + pPath + " not found.");
+const Doc* Doc::lookupNode(std::string_view pPath) const
+{
+  const Doc* currentDoc = this;
+  if (pPath.empty()) {
+    if (LookupStats* stats = lookupStats()) {
+      countLookup(*stats, 0, 0, true);
     }
+    return currentDoc;
   }
 
+  size_t start = 0;
+  while (true) {
+    size_t end = pPath.find('.', start);
+    if (end == std::string_view::npos) {
+      end = pPath.size();
+    }
+
+    currentDoc = currentDoc->lookupChild(pPath.substr(start, end - start));
+    if (currentDoc == nullptr || end == pPath.size()) {
+      if (LookupStats* stats = lookupStats()) {
+        countLookup(*stats,
+                    countSegments(pPath),
+                    countSegments(pPath.substr(0, end)),
+                    currentDoc != nullptr);
+      }
+      return currentDoc;
+    }
+    start = end + 1;
+  }
+}
+
+const Doc* Doc::lookupNode(const Path& pPath) const
+{
+  const Doc* currentDoc = this;
+  for (const Path::Segment& segment : pPath) {
+    currentDoc = currentDoc->lookupChild(segment.key, segment.hash);
+    if (currentDoc == nullptr) {
+      if (LookupStats* stats = lookupStats()) {
+        countLookup(*stats, pPath.size(), &segment - pPath.begin() + 1, false);
+      }
+      return nullptr;
+    }
+  }
+
+  if (LookupStats* stats = lookupStats()) {
+    countLookup(*stats, pPath.size(), pPath.size(), true);
+  }
   return currentDoc;
 }
 
-bool Doc::tryGetNode(const std::string& pPath, Doc*& pOut)
+template<typename Node>
+void Doc::walk(Node* pNode,
+               const PathSet& pPaths,
+               uint32_t pEntry,
+               Node** pOut,
+               size_t& pFound)
 {
-  if (pPath.empty()) {
-    pOut = this;
-    return true;
+  const PathSet::Entry& entry = pPaths.entries[pEntry];
+  if (entry.path != PathSet::NONE) {
+    pOut[entry.path] = pNode;
+    pFound++;
+  }
+
+  if (entry.firstChild == PathSet::NONE || pNode->getChildCount() == 0) {
+    return;
+  }
+
+  // each segment is resolved to a key id once for all the paths sharing it
+  const KeyTable& keys = pNode->arena->getKeys();
+  for (uint32_t next = entry.firstChild; next != PathSet::NONE;
+       next = pPaths.entries[next].nextSibling) {
+    const PathSet::Entry& segment = pPaths.entries[next];
+    uint32_t wanted = keys.find(pPaths.key(segment), segment.hash);
+    if (wanted == KeyTable::NOT_FOUND) {
+      continue;
+    }
+
+    Node* child;
+    if constexpr (std::is_const_v<Node>) {
+      child = pNode->lookupChild(wanted);
+    } else {
+      child = pNode->findChild(wanted);
+    }
+    if (child != nullptr) {
+      walk(child, pPaths, next, pOut, pFound);
+    }
+  }
+}
+
+size_t Doc::lookup(const PathSet& pPaths, Doc** pOut)
+{
+  std::fill(pOut, pOut + pPaths.size(), nullptr);
+  size_t found = 0;
+  walk(this, pPaths, 0, pOut, found);
+  if (LookupStats* stats = lookupStats()) {
+    countLookups(*stats, pPaths, found);
   }
+  return found;
+}
 
-  std::stringstream ss(pPath);
-  std::string token;
+size_t Doc::lookup(const PathSet& pPaths, const Doc** pOut) const
+{
+  std::fill(pOut, pOut + pPaths.size(), nullptr);
+  size_t found = 0;
+  walk(this, pPaths, 0, pOut, found);
+  if (LookupStats* stats = lookupStats()) {
+    countLookups(*stats, pPaths, found);
+  }
+  return found;
+}
+
+Doc* Doc::findNode(const Path& pPath)
+{
   Doc* currentDoc = this;
+  for (const Path::Segment& segment : pPath) {
+    currentDoc = currentDoc->findChild(segment.key, segment.hash);
+    if (currentDoc == nullptr) {
+      if (LookupStats* stats = lookupStats()) {
+        countLookup(*stats, pPath.size(), &segment - pPath.begin() + 1, false);
+      }
+      return nullptr;
+    }
+  }
+
+  if (LookupStats* stats = lookupStats()) {
+    countLookup(*stats, pPath.size(), pPath.size(), true);
+  }
+  return currentDoc;
+}
 
-  while (std::getline(ss, token, '.')) {
-    bool found = false;
-    for (int i = 0; i < currentDoc->children.size(); i++) {
-      if (currentDoc->children[i].name == token) {
-        currentDoc = &currentDoc->children[i];
-        found = true;
-        break;
+void Doc::copyChildren(const Doc& pSource)
+{
+  size_t budget = MAX_ALIAS_EXPANSION;
+  copyChildren(pSource, pSource.isAlias(), budget);
+}
+
+void Doc::copyChildren(const Doc& pAlias, bool pExpanding, size_t& pBudget)
+{
+  const Doc& source = *pAlias.content();
+  if (source.firstChild == DocArena::NO_NODE) {
+    return;
+  }
+
+  // text from the source's input buffers is shared, everything else is
+  // copied into this arena
+  ensureArena();
+  if (source.arena != arena) {
+    arena->retainAll(*source.arena);
+  }
+
+  // preorder walk over the source subtree following sibling and parent links,
+  // so deep documents don't recurse. Aliases are expanded, the nodes that
+  // creates count against pBudget.
+  Doc* target = this;
+  const Doc* current = source.node(source.firstChild);
+  while (true) {
+    if (pExpanding && pBudget-- == 0) {
+      throw DocNodeException("Expanding the aliases of " +
+                             pAlias.getName() + " creates more than " +
+                             std::to_string(MAX_ALIAS_EXPANSION) + " nodes.");
+    }
+
+    // keys are shared within an arena, interned again in another
+    Doc* copy = source.arena == arena
+                  ? target->appendChild(current->key)
+                  : target->appendChild(current->getNameView());
+    copy->copyContent(*current);
+
+    if (current->isAlias()) {
+      copy->copyChildren(*current, true, pBudget);
+    } else if (current->firstChild != DocArena::NO_NODE) {
+      target = copy;
+      current = current->node(current->firstChild);
+      continue;
+    }
+
+    while (current->nextSibling == DocArena::NO_NODE) {
+      current = current->getParent();
+      if (current == &source) {
+        return;
       }
+      target = target->getParent();
     }
 
-    if (!found) {
-      pOut = nullptr;
-      return false;
+    current = current->node(current->nextSibling);
+  }
+}
+
+void Doc::shareChildren(const Doc& pSource)
+{
+  const Doc& source = *pSource.content();
+  if (source.firstChild == DocArena::NO_NODE) {
+    return;
+  }
+
+  ensureArena();
+  if (source.arena != arena) {
+    arena->retainAll(*source.arena);
+  }
+  auto copyKey = [&](const Doc& pNode) {
+    return source.arena == arena ? pNode.key
+                                 : arena->internKey(pNode.getNameView());
+  };
+
+  // the copy of each node shared by the aliases of the subtree, by index in
+  // the source arena. Those outside of it, or met through an alias before
+  // the walk reaches them, are copied detached as removed anchors are.
+  std::unordered_map<uint32_t, uint32_t> copies;
+  for (const Doc& node : source.depthFirst()) {
+    if (node.isAlias()) {
+      copies.emplace(node.alias, DocArena::NO_NODE);
+    }
+  }
+  std::vector<std::pair<const Doc*, Doc*>> pending = { { &source, this } };
+
+  // preorder walk as copyChildren(), aliases point to the copy of their
+  // anchored node instead of being expanded
+  auto copySubtree = [&](const Doc* pFrom, Doc* pInto) {
+    if (pFrom->firstChild == DocArena::NO_NODE) {
+      return;
     }
+
+    Doc* target = pInto;
+    const Doc* current = pFrom->node(pFrom->firstChild);
+    while (true) {
+      Doc* copy = target->appendChild(copyKey(*current));
+      copy->copyContent(*current);
+      if (!copies.empty()) {
+        auto found = copies.find(current->index);
+        if (found != copies.end() && found->second == DocArena::NO_NODE) {
+          found->second = copy->index;
+        }
+      }
+
+      if (current->isAlias()) {
+        uint32_t& shared =
+          copies.try_emplace(current->alias, DocArena::NO_NODE).first->second;
+        if (shared == DocArena::NO_NODE) {
+          const Doc* anchored = current->content();
+          shared = arena->allocate();
+          Doc* detached = node(shared);
+          detached->arena = arena;
+          detached->index = shared;
+          detached->key = copyKey(*anchored);
+          detached->copyContent(*anchored);
+          pending.emplace_back(anchored, detached);
+        }
+        copy->alias = shared;
+      } else if (current->firstChild != DocArena::NO_NODE) {
+        target = copy;
+        current = current->node(current->firstChild);
+        continue;
+      }
+
+      while (current->nextSibling == DocArena::NO_NODE) {
+        current = current->getParent();
+        if (current == pFrom) {
+          return;
+        }
+        target = target->getParent();
+      }
+
+      current = current->node(current->nextSibling);
+    }
+  };
+
+  while (!pending.empty()) {
+    auto [from, into] = pending.back();
+    pending.pop_back();
+    copySubtree(from, into);
+  }
+}
+
+void Doc::detachChildren()
+{
+  // detached nodes stay in the arena until the root is released
+  firstChild = DocArena::NO_NODE;
+  lastChild = DocArena::NO_NODE;
+  childCount = 0;
+  childIndex = DocArena::NO_NODE;
+  alias = DocArena::NO_NODE;
+}
+
+std::vector<Doc> Doc::getChildren() const
+{
+  const Doc* source = content();
+  std::vector<Doc> copies;
+  copies.reserve(source->childCount);
+  for (uint32_t i = source->firstChild; i != DocArena::NO_NODE;
+       i = node(i)->nextSibling) {
+    copies.push_back(*node(i));
+  }
+  return copies;
+}
+
+std::string Doc::toString(int pDepth) const
+{
+  std::string str;
+  DocWriter([&str](std::string_view pText) { str += pText; })
+    .writeTree(*this, pDepth);
+  return str;
+}
+
+std::string Doc::toString() const
+{
+  return toString(0);
+}
+
+std::string Doc::toYaml() const
+{
+  std::string str;
+  DocWriter([&str](std::string_view pText) { str += pText; }).writeYaml(*this);
+  return str;
+}
+
+void Doc::writeYaml(std::ostream& pOut) const
+{
+  DocWriter(pOut).writeYaml(*this);
+}
+
+void Doc::setLookupStats(LookupStats* pStats) const
+{
+  if (arena) {
+    arena->setLookupStats(pStats);
+  }
+}
+
+void Doc::collectStats(ParseStats& pStats) const
+{
+  std::vector<std::pair<const Doc*, size_t>> pending = { { this, 0 } };
+  while (!pending.empty()) {
+    auto [current, depth] = pending.back();
+    pending.pop_back();
+
+    pStats.nodesByType[current->type]++;
+    pStats.maxDepth = std::max(pStats.maxDepth, depth);
+    if (current != this) {
+      pStats.keyBytes += current->getNameView().size();
+    }
+    pStats.valueBytes += current->value.size();
+    // the anchored node is counted on its own
+    if (current->isAlias()) {
+      pStats.aliases++;
+      continue;
+    }
+
+    if (current->type == MAPPING) {
+      pStats.widestMapping =
+        std::max<size_t>(pStats.widestMapping, current->childCount);
+    }
+    for (const Doc* child = current->getFirstChild(); child;
+         child = child->getNextSibling()) {
+      pending.push_back({ child, depth + 1 });
+    }
+  }
+
+  if (arena) {
+    pStats.storedBytes = arena->getStoredBytes();
+    pStats.keys = arena->getKeys().size();
+    pStats.allocations = arena->countAllocations();
+  }
+}
+
+DocResult<Doc*> Doc::lookup(std::string_view pPath)
+{
+  Doc* node = findNode(pPath);
+  if (node == nullptr) {
+    return DocError::NOT_FOUND;
+  }
+  return node;
+}
+
+DocResult<Doc*> Doc::lookup(const Path& pPath)
+{
+  Doc* node = findNode(pPath);
+  if (node == nullptr) {
+    return DocError::NOT_FOUND;
+  }
+  return node;
+}
+
+DocResult<const Doc*> Doc::lookup(std::string_view pPath) const
+{
+  const Doc* node = lookupNode(pPath);
+  if (node == nullptr) {
+    return DocError::NOT_FOUND;
+  }
+  return node;
+}
+
+DocResult<const Doc*> Doc::lookup(const Path& pPath) const
+{
+  const Doc* node = lookupNode(pPath);
+  if (node == nullptr) {
+    return DocError::NOT_FOUND;
+  }
+  return node;
+}
+
+Doc* Doc::getNode(const std::string& pPath)
+{
+  DocResult<Doc*> node = lookup(std::string_view(pPath));
+  if (!node) {
+    throw DocNodeException("Node " + pPath + " not found.");
+  }
+
+  return *node;
+}
+
+Doc* Doc::getNode(const Path& pPath)
+{
+  DocResult<Doc*> node = lookup(pPath);
+  if (!node) {
+    throw DocNodeException("Node " + std::string(pPath.str()) +
+                           " not found.");
+  }
+
+  return *node;
+}
+
+const Doc* Doc::getNode(const std::string& pPath) const
+{
+  DocResult<const Doc*> node = lookup(std::string_view(pPath));
+  if (!node) {
+    throw DocNodeException("Node " + pPath + " not found.");
+  }
+
+  return *node;
+}
+
+const Doc* Doc::getNode(const Path& pPath) const
+{
+  DocResult<const Doc*> node = lookup(pPath);
+  if (!node) {
+    throw DocNodeException("Node " + std::string(pPath.str()) +
+                           " not found.");
   }
 
-  pOut = currentDoc;
-  return true;
+  return *node;
+}
+
+bool Doc::tryGetNode(const std::string& pPath, Doc*& pOut)
+{
+  pOut = findNode(std::string_view(pPath));
+  return pOut != nullptr;
+}
+
+bool Doc::tryGetNode(const Path& pPath, Doc*& pOut)
+{
+  pOut = findNode(pPath);
+  return pOut != nullptr;
+}
+
+bool Doc::tryGetNode(const std::string& pPath, const Doc*& pOut) const
+{
+  pOut = lookupNode(std::string_view(pPath));
+  return pOut != nullptr;
+}
+
+bool Doc::tryGetNode(const Path& pPath, const Doc*& pOut) const
+{
+  pOut = lookupNode(pPath);
+  return pOut != nullptr;
 }
 
 std::string Doc::getValue(const std::string& pPath)
@@ -293,6 +1110,12 @@ std::string Doc::getValue(const std::string& pPath)
   return node->getValue();
 }
 
+std::string Doc::getValue(const Path& pPath)
+{
+  Doc* node = getNode(pPath);
+  return node->getValue();
+}
+
 std::string Doc::getValue(const std::string& pPath, const std::string& pDefault)
 {
   Doc* node;
@@ -302,6 +1125,68 @@ std::string Doc::getValue(const std::string& pPath, const std::string& pDefault)
   return pDefault;
 }
 
+std::string Doc::getValue(const Path& pPath, const std::string& pDefault)
+{
+  Doc* node;
+  if (tryGetNode(pPath, node)) {
+    return node->getValue();
+  }
+  return pDefault;
+}
+
+std::string Doc::getValue(const std::string& pPath, const char* pDefault)
+{
+  Doc* node;
+  if (tryGetNode(pPath, node)) {
+    return node->getValue();
+  }
+  return pDefault;
+}
+
+std::string Doc::getValue(const Path& pPath, const char* pDefault)
+{
+  Doc* node;
+  if (tryGetNode(pPath, node)) {
+    return node->getValue();
+  }
+  return pDefault;
+}
+
+std::string Doc::getValue(const std::string& pPath) const
+{
+  return getNode(pPath)->getValue();
+}
+
+std::string Doc::getValue(const Path& pPath) const
+{
+  return getNode(pPath)->getValue();
+}
+
+std::string Doc::getValue(const std::string& pPath,
+                          std::string_view pDefault) const
+{
+  const Doc* node;
+  if (tryGetNode(pPath, node)) {
+    return node->getValue();
+  }
+  return std::string(pDefault);
+}
+
+std::string Doc::getValue(const Path& pPath, std::string_view pDefault) const
+{
+  const Doc* node;
+  if (tryGetNode(pPath, node)) {
+    return node->getValue();
+  }
+  return std::string(pDefault);
+}
+
+template<>
+std::string_view Doc::getValue() const
+{
+  return value;
+}
+
 bool Doc::tryGetValue(const std::string& pPath,
                       std::string* pOut,
                       const std::string& pDefaultValue)
@@ -321,6 +1206,25 @@ bool Doc::tryGetValue(const std::string& pPath,
   return false;
 }
 
+bool Doc::tryGetValue(const Path& pPath,
+                      std::string* pOut,
+                      const std::string& pDefaultValue)
+{
+  Doc* node;
+  if (tryGetNode(pPath, node)) {
+    if (pOut != nullptr) {
+      *pOut = node->getValue();
+      return true;
+    }
+  }
+
+  if (pOut != nullptr) {
+    *pOut = pDefaultValue;
+  }
+
+  return false;
+}
+
 bool Doc::tryGetValue(const std::string& pPath, std::string* pOut)
 {
   Doc* node;
@@ -334,32 +1238,75 @@ bool Doc::tryGetValue(const std::string& pPath, std::string* pOut)
   return false;
 }
 
+bool Doc::tryGetValue(const Path& pPath, std::string* pOut)
+{
+  Doc* node;
+  if (tryGetNode(pPath, node)) {
+    if (pOut != nullptr) {
+      *pOut = node->getValue();
+      return true;
+    }
+  }
+
+  return false;
+}
+
 template<>
 const char* Doc::getValueOr(const char* pDefault)
 {
-  if (children.size() == 0) {
-    return value.c_str();
+  // an alias has the children of its anchored node
+  if (getChildCount() != 0) {
+    return pDefault;
   }
 
-  return pDefault;
+  if (value.empty()) {
+    return "";
+  }
+
+  // slices of the input aren't NUL terminated, copy them once on demand
+  if (!(flags & TERMINATED_VALUE)) {
+    value = ensureArena()->storeString(value);
+    flags |= TERMINATED_VALUE;
+  }
+
+  return value.data();
 }
 
 template<>
-bool Doc::getValue()
+bool Doc::getValue() const
 {
-  try {
-    int intValue = std::stoi(value);
-    return intValue == 1;
-  } catch (std::exception& e) {
-  }
+  bool returnValue;
+  return toBool(returnValue) && returnValue;
+}
+
+bool Doc::toBool(bool& pOut) const
+{
+  switch (kind) {
+    case Scalar::BOOLEAN:
+      pOut = number.integer != 0;
+      return true;
 
-  return value == "true";
+    case Scalar::INTEGER:
+      pOut = number.integer == 1;
+      return true;
+
+    case Scalar::STRING: {
+      int64_t integer;
+      if (Scalar::parseInteger(value, integer)) {
+        pOut = integer == 1;
+        return true;
+      }
+      return Scalar::parseBool(value, pOut);
+    }
+
+    default:
+      return false;
+  }
 }
 
 std::ostream& operator<<(std::ostream& os, const Doc& doc)
 {
-  std::string str = doc.toString();
-  os << str;
+  DocWriter(os).writeTree(doc);
   return os;
 }
 
@@ -0,0 +1,220 @@
+#include "DocArena.hpp"
+
+#include "Doc.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace YAML {
+DocArena::DocArena(Doc* pRoot, std::pmr::memory_resource* pMemory)
+  : root(pRoot)
+  , memory(pMemory)
+  , stringBlocks(pMemory)
+  , buffers(pMemory)
+  , indexes(pMemory)
+  , keys(pMemory)
+{
+}
+
+DocArena* DocArena::create(Doc* pRoot, std::pmr::memory_resource* pMemory)
+{
+  if (pMemory == nullptr) {
+    pMemory = std::pmr::get_default_resource();
+  }
+
+  void* place = pMemory->allocate(sizeof(DocArena), alignof(DocArena));
+  try {
+    return new (place) DocArena(pRoot, pMemory);
+  } catch (...) {
+    pMemory->deallocate(place, sizeof(DocArena), alignof(DocArena));
+    throw;
+  }
+}
+
+void DocArena::destroy(DocArena* pArena)
+{
+  if (pArena == nullptr) {
+    return;
+  }
+
+  std::pmr::memory_resource* memory = pArena->memory;
+  pArena->~DocArena();
+  memory->deallocate(pArena, sizeof(DocArena), alignof(DocArena));
+}
+
+DocArena::~DocArena()
+{
+  uint32_t remaining = count;
+  for (uint32_t chunk = 0; chunk < MAX_CHUNKS && chunks[chunk]; chunk++) {
+    size_t capacity = chunkCapacity(chunk);
+    size_t used = remaining < capacity ? remaining : capacity;
+    for (size_t i = 0; i < used; i++) {
+      chunks[chunk][i].~Doc();
+    }
+    remaining -= used;
+    memory->deallocate(
+      chunks[chunk], sizeof(Doc) * chunkCapacity(chunk), alignof(Doc));
+  }
+
+  for (const StringBlock& block : stringBlocks) {
+    memory->deallocate(block.data, block.size, 1);
+  }
+}
+
+uint32_t DocArena::allocate()
+{
+  if (count >= ROOT_NODE) {
+    throw std::bad_alloc();
+  }
+
+  uint32_t index = count;
+  uint32_t chunk, offset;
+  locate(index, chunk, offset);
+
+  if (chunks[chunk] == nullptr) {
+    chunks[chunk] = static_cast<Doc*>(
+      memory->allocate(sizeof(Doc) * chunkCapacity(chunk), alignof(Doc)));
+  }
+
+  new (chunks[chunk] + offset) Doc();
+  count++;
+  return index;
+}
+
+uint32_t DocArena::allocate(uint32_t pCount)
+{
+  if (pCount > ROOT_NODE - count) {
+    throw std::bad_alloc();
+  }
+
+  uint32_t first = count;
+  while (count < first + pCount) {
+    uint32_t chunk, offset;
+    locate(count, chunk, offset);
+
+    if (chunks[chunk] == nullptr) {
+      chunks[chunk] = static_cast<Doc*>(
+        memory->allocate(sizeof(Doc) * chunkCapacity(chunk), alignof(Doc)));
+    }
+
+    // the rest of the chunk or of the nodes asked for
+    size_t run = std::min<size_t>(chunkCapacity(chunk) - offset,
+                                  first + pCount - count);
+    for (size_t i = 0; i < run; i++) {
+      new (chunks[chunk] + offset + i) Doc();
+    }
+    count += run;
+  }
+  return first;
+}
+
+std::string_view DocArena::storeString(std::string_view pString)
+{
+  // stored strings are always followed by a NUL so they can be handed out
+  // as C strings
+  size_t size = pString.size() + 1;
+  storedBytes += size;
+
+  if (size > stringAvailable) {
+    if (size > nextStringBlock / 4) {
+      char* block = allocateBlock(size);
+      std::memcpy(block, pString.data(), pString.size());
+      block[pString.size()] = '\0';
+      return std::string_view(block, pString.size());
+    }
+
+    stringCursor = allocateBlock(nextStringBlock);
+    stringAvailable = nextStringBlock;
+    if (nextStringBlock < MAX_STRING_BLOCK) {
+      nextStringBlock *= 2;
+    }
+  }
+
+  char* stored = stringCursor;
+  std::memcpy(stored, pString.data(), pString.size());
+  stored[pString.size()] = '\0';
+  stringCursor += size;
+  stringAvailable -= size;
+  return std::string_view(stored, pString.size());
+}
+
+char* DocArena::allocateBlock(size_t pSize)
+{
+  stringBlocks.reserve(stringBlocks.size() + 1);
+  char* block = static_cast<char*>(memory->allocate(pSize, 1));
+  stringBlocks.push_back({ block, pSize });
+  return block;
+}
+
+std::string_view DocArena::adoptString(std::string_view pString)
+{
+  if (pString.empty() || isRetained(pString)) {
+    return pString;
+  }
+
+  return storeString(pString);
+}
+
+void DocArena::retain(std::shared_ptr<const void> pOwner,
+                      std::string_view pBytes)
+{
+  buffers.push_back({ std::move(pOwner), pBytes });
+}
+
+void DocArena::retainAll(const DocArena& pOther)
+{
+  for (const RetainedBuffer& buffer : pOther.buffers) {
+    if (!isRetained(buffer.bytes)) {
+      buffers.push_back(buffer);
+    }
+  }
+}
+
+bool DocArena::isRetained(std::string_view pString) const
+{
+  auto begin = reinterpret_cast<uintptr_t>(pString.data());
+  auto end = begin + pString.size();
+  for (const RetainedBuffer& buffer : buffers) {
+    auto bufferBegin = reinterpret_cast<uintptr_t>(buffer.bytes.data());
+    auto bufferEnd = bufferBegin + buffer.bytes.size();
+    if (begin >= bufferBegin && end <= bufferEnd) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+size_t DocArena::countAllocations() const
+{
+  size_t allocations = stringBlocks.size() + indexes.size();
+  for (Doc* chunk : chunks) {
+    allocations += chunk != nullptr;
+  }
+  return allocations;
+}
+
+uint32_t DocArena::internKey(std::string_view pKey)
+{
+  return internKey(pKey, hashKey(pKey));
+}
+
+uint32_t DocArena::internKey(std::string_view pKey, uint64_t pHash)
+{
+  return keys.intern(
+    pKey, pHash, [this](std::string_view pNew) { return adoptString(pNew); });
+}
+
+uint32_t DocArena::itemKey(uint32_t pIndex)
+{
+  return keys.internItem(
+    pIndex, [this](std::string_view pNew) { return storeString(pNew); });
+}
+
+uint32_t DocArena::createIndex()
+{
+  indexes.emplace_back();
+  return static_cast<uint32_t>(indexes.size() - 1);
+}
+}
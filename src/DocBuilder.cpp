@@ -0,0 +1,373 @@
+#include "DocBuilder.hpp"
+
+#include "exceptions/DocParserException.hpp"
+
+namespace YAML {
+DocBuilder::DocBuilder(Doc& pRoot, const Selection* pSelection)
+  : arena(pRoot.ensureArena())
+  , current(&pRoot)
+  , selection(pSelection)
+{
+}
+
+void DocBuilder::onMappingStart(std::string_view pPath)
+{
+  if (enterValue(pPath, true)) {
+    startContainer(pPath, Doc::MAPPING);
+  }
+}
+
+void DocBuilder::onMappingEnd(std::string_view pPath)
+{
+  endContainer(pPath);
+}
+
+void DocBuilder::onSequenceStart(std::string_view pPath)
+{
+  if (enterValue(pPath, true)) {
+    startContainer(pPath, Doc::SEQUENCE);
+  }
+}
+
+void DocBuilder::onSequenceEnd(std::string_view pPath)
+{
+  endContainer(pPath);
+}
+
+void DocBuilder::onKey(std::string_view pPath,
+                       std::string_view pKey,
+                       bool pPlain)
+{
+  if (skipDepth > 0) {
+    return;
+  }
+
+  if (selection && selectedDepth == 0) {
+    Selection::Match match = selection->match(pPath);
+    if (match == Selection::OUTSIDE) {
+      skipValue = true;
+      return;
+    }
+    selectValue = match == Selection::INSIDE;
+  }
+
+  Doc* mapping = current;
+  current = current->appendChild(pKey);
+  current->type = Doc::SCALAR;
+
+  // quoted "<<" keys are plain strings
+  if (pPlain && pKey == "<<" &&
+      (merges.empty() || merges.back().mapping != mapping)) {
+    merges.push_back({ mapping, current });
+  }
+}
+
+void DocBuilder::onScalar(std::string_view pPath,
+                          std::string_view pValue,
+                          std::string_view pTag,
+                          bool pPlain)
+{
+  if (!enterValue(pPath, false)) {
+    return;
+  }
+
+  Doc* node = valueNode(pPath);
+  node->type = Doc::SCALAR;
+  node->setScalar(arena->adoptString(pValue), pPlain, pTag);
+
+  if (!anchor.empty()) {
+    addAnchor(node, anchor);
+    anchor.clear();
+  }
+  if (node == detached) {
+    resume();
+  }
+}
+
+void DocBuilder::onAnchor(std::string_view /*pPath*/,
+                          std::string_view pAnchor)
+{
+  anchor = pAnchor;
+}
+
+void DocBuilder::onAlias(std::string_view pPath, std::string_view pAnchor)
+{
+  if (!enterValue(pPath, false)) {
+    return;
+  }
+
+  auto found = anchors.find(std::string(pAnchor));
+  if (found == anchors.end()) {
+    for (const auto& [openDepth, name] : openAnchors) {
+      if (name == pAnchor) {
+        throw DocParserException("Alias *" + name +
+                                 " is inside the node it refers to, at " +
+                                 std::string(pPath));
+      }
+    }
+    throw DocParserException("Unknown anchor " + std::string(pAnchor) +
+                             ", at " + std::string(pPath));
+  }
+
+  Doc* target = current->node(found->second);
+  valueNode(pPath)->makeAlias(*target);
+}
+
+bool DocBuilder::enterValue(std::string_view pPath, bool pContainer)
+{
+  if (skipDepth > 0 || skipValue) {
+    skipValue = false;
+    if (!anchor.empty()) {
+      detach();
+      return true;
+    }
+    skipDepth += pContainer;
+    return false;
+  }
+
+  // keys are matched in onKey(), sequence items and the top level node here
+  if (selection && selectedDepth == 0 && current->type != Doc::SCALAR) {
+    Selection::Match match = selection->match(pPath);
+    if (match == Selection::OUTSIDE) {
+      if (!anchor.empty()) {
+        detach();
+        return true;
+      }
+      skipDepth += pContainer;
+      return false;
+    }
+    selectValue = match == Selection::INSIDE;
+  }
+
+  return true;
+}
+
+void DocBuilder::startContainer(std::string_view pPath, Doc::Type pType)
+{
+  Doc* node = current->type == Doc::SEQUENCE ? addItem(pPath) : current;
+  node->type = pType;
+  current = node;
+
+  depth++;
+  if (selectValue) {
+    selectedDepth = depth;
+    selectValue = false;
+  }
+
+  // containers can only be aliased once complete
+  if (!anchor.empty()) {
+    openAnchors.emplace_back(depth, std::move(anchor));
+    anchor.clear();
+  }
+}
+
+void DocBuilder::endContainer(std::string_view pPath)
+{
+  if (skipDepth > 0) {
+    skipDepth--;
+    return;
+  }
+
+  if (!merges.empty() && merges.back().mapping == current) {
+    Doc* mergeKey = merges.back().key;
+    merges.pop_back();
+    merge(current, mergeKey, pPath);
+  }
+  if (current->childIndex == DocArena::NO_NODE &&
+      current->childCount >= ChildIndex::THRESHOLD) {
+    current->buildIndex();
+  }
+
+  if (!openAnchors.empty() && openAnchors.back().first == depth) {
+    addAnchor(current, openAnchors.back().second);
+    openAnchors.pop_back();
+  }
+  if (selectedDepth == depth) {
+    selectedDepth = 0;
+  }
+  depth--;
+
+  if (current == detached) {
+    resume();
+  } else if (current->getParent()) {
+    current = current->getParent();
+  }
+}
+
+void DocBuilder::detach()
+{
+  resumeNode = current;
+  resumeSkipDepth = skipDepth;
+  resumeSelectedDepth = selectedDepth;
+  skipDepth = 0;
+  selectValue = true;
+
+  uint32_t index = arena->allocate();
+  detached = current->node(index);
+  detached->arena = arena;
+  detached->index = index;
+  current = detached;
+}
+
+void DocBuilder::resume()
+{
+  current = resumeNode;
+  skipDepth = resumeSkipDepth;
+  selectedDepth = resumeSelectedDepth;
+  detached = nullptr;
+}
+
+void DocBuilder::addAnchor(Doc* pNode, std::string_view pAnchor)
+{
+  // the root is only complete once the document is, nothing can refer to it
+  if (pNode->ownsArena()) {
+    return;
+  }
+
+  // an anchor defined again refers to the latest node from there on
+  anchors.insert_or_assign(std::string(pAnchor), pNode->index);
+}
+
+void DocBuilder::merge(Doc* pMapping, Doc* pMergeKey, std::string_view pPath)
+{
+  pMapping->unlinkChild(pMergeKey);
+
+  // a mapping, or a sequence of mappings where the first ones take precedence
+  std::vector<Doc*> sources;
+  Doc* value = pMergeKey->content();
+  if (value->type == Doc::SEQUENCE) {
+    for (Doc& item : value->children()) {
+      sources.push_back(item.content());
+    }
+  } else {
+    sources.push_back(value);
+  }
+
+  size_t incoming = 0;
+  for (Doc* source : sources) {
+    if (source->type != Doc::MAPPING) {
+      throw DocParserException(
+        "Merge keys take a mapping or a sequence of mappings, at " +
+        std::string(pPath));
+    }
+    incoming += source->childCount;
+  }
+  if (pMapping->childIndex == DocArena::NO_NODE &&
+      pMapping->childCount + incoming >= ChildIndex::THRESHOLD) {
+    pMapping->buildIndex();
+  }
+
+  // keys of the mapping itself win over merged ones, merged entries are
+  // shared with their source
+  for (Doc* source : sources) {
+    for (Doc& entry : source->children()) {
+      if (pMapping->findChild(entry.getNameView()) == nullptr) {
+        pMapping->appendChild(entry.key)->makeAlias(entry);
+      }
+    }
+  }
+}
+
+Doc* DocBuilder::valueNode(std::string_view pPath)
+{
+  selectValue = false;
+  switch (current->type) {
+    case Doc::SEQUENCE:
+      return addItem(pPath);
+
+    case Doc::SCALAR: {
+      // the placeholder created by onKey()
+      Doc* node = current;
+      if (current->getParent()) {
+        current = current->getParent();
+      }
+      return node;
+    }
+
+    default:
+      return current;
+  }
+}
+
+Doc* DocBuilder::addItem(std::string_view pPath)
+{
+  if (selection == nullptr) {
+    return current->addSequenceItem();
+  }
+
+  // skipped items leave gaps, keep the index the item has in the input
+  return current->appendChild(pPath.substr(pPath.rfind('.') + 1));
+}
+
+StreamBuilder::StreamBuilder(std::shared_ptr<const void> pOwner,
+                             std::string_view pBytes,
+                             std::pmr::memory_resource* pMemory,
+                             Doc::Handler pOnDocument)
+  : owner(std::move(pOwner))
+  , bytes(pBytes)
+  , memory(pMemory)
+  , onDocument(std::move(pOnDocument))
+{
+}
+
+void StreamBuilder::onDocumentStart()
+{
+  document = std::make_unique<Doc>();
+  document->initRoot(owner, bytes, memory);
+  builder.emplace(*document);
+}
+
+void StreamBuilder::onDocumentEnd()
+{
+  builder.reset();
+  std::unique_ptr<Doc> complete = std::move(document);
+  onDocument(std::move(*complete));
+}
+
+void StreamBuilder::onMappingStart(std::string_view pPath)
+{
+  builder->onMappingStart(pPath);
+}
+
+void StreamBuilder::onMappingEnd(std::string_view pPath)
+{
+  builder->onMappingEnd(pPath);
+}
+
+void StreamBuilder::onSequenceStart(std::string_view pPath)
+{
+  builder->onSequenceStart(pPath);
+}
+
+void StreamBuilder::onSequenceEnd(std::string_view pPath)
+{
+  builder->onSequenceEnd(pPath);
+}
+
+void StreamBuilder::onKey(std::string_view pPath,
+                          std::string_view pKey,
+                          bool pPlain)
+{
+  builder->onKey(pPath, pKey, pPlain);
+}
+
+void StreamBuilder::onScalar(std::string_view pPath,
+                             std::string_view pValue,
+                             std::string_view pTag,
+                             bool pPlain)
+{
+  builder->onScalar(pPath, pValue, pTag, pPlain);
+}
+
+void StreamBuilder::onAnchor(std::string_view pPath,
+                             std::string_view pAnchor)
+{
+  builder->onAnchor(pPath, pAnchor);
+}
+
+void StreamBuilder::onAlias(std::string_view pPath, std::string_view pAnchor)
+{
+  builder->onAlias(pPath, pAnchor);
+}
+
+}
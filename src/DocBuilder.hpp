@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Doc.hpp"
+#include "DocVisitor.hpp"
+#include "Selection.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace YAML {
+
+// The visitor behind parseFile() and parseString(), building the nodes of a
+// document below its root. Keys and values that lie in a buffer retained by
+// the arena are kept as views, anything else is copied into the arena. With a
+// selection, subtrees outside of it are skipped without creating any node.
+//
+// Aliases become nodes sharing the children of their anchored node, and merge
+// keys ("<<") add aliases of the merged entries to their mapping once it's
+// complete. Anchored values outside of a selection are still built, detached
+// from the tree, so that selected aliases can share them.
+class DocBuilder : public DocVisitor
+{
+public:
+  DocBuilder(Doc& pRoot, const Selection* pSelection = nullptr);
+
+  void onMappingStart(std::string_view pPath) override;
+  void onMappingEnd(std::string_view pPath) override;
+  void onSequenceStart(std::string_view pPath) override;
+  void onSequenceEnd(std::string_view pPath) override;
+  void onKey(std::string_view pPath,
+             std::string_view pKey,
+             bool pPlain) override;
+  void onScalar(std::string_view pPath,
+                std::string_view pValue,
+                std::string_view pTag,
+                bool pPlain) override;
+  void onAnchor(std::string_view pPath, std::string_view pAnchor) override;
+  void onAlias(std::string_view pPath, std::string_view pAnchor) override;
+
+private:
+  // false when the value starting at pPath is left out
+  bool enterValue(std::string_view pPath, bool pContainer);
+
+  void startContainer(std::string_view pPath, Doc::Type pType);
+  void endContainer(std::string_view pPath);
+
+  // builds the next value off the tree, and goes back to skipping after it
+  void detach();
+  void resume();
+
+  void addAnchor(Doc* pNode, std::string_view pAnchor);
+  void merge(Doc* pMapping, Doc* pMergeKey, std::string_view pPath);
+
+  // the node the next value goes into
+  Doc* valueNode(std::string_view pPath);
+  Doc* addItem(std::string_view pPath);
+
+private:
+  DocArena* arena;
+  Doc* current;
+
+  const Selection* selection;
+  // open containers being built, and the one from which everything is
+  // selected (0 when matching is still needed)
+  uint32_t depth = 0;
+  uint32_t selectedDepth = 0;
+  // open containers being skipped
+  uint32_t skipDepth = 0;
+  bool skipValue = false;
+  bool selectValue = false;
+
+  // anchored nodes by name, the anchor of the next value, and the anchors of
+  // open containers with their depth
+  std::unordered_map<std::string, uint32_t> anchors;
+  std::string anchor;
+  std::vector<std::pair<uint32_t, std::string>> openAnchors;
+  // open mappings having a merge key, with their first one
+  struct Merge
+  {
+    Doc* mapping;
+    Doc* key;
+  };
+  std::vector<Merge> merges;
+
+  // the anchored value being built off the tree, and the state to go back to
+  Doc* detached = nullptr;
+  Doc* resumeNode = nullptr;
+  uint32_t resumeSkipDepth = 0;
+  uint32_t resumeSelectedDepth = 0;
+};
+
+// Builds one document per document of the stream instead of folding them
+// into a single root. Scalars are kept as views into pBytes, retained by every
+// document through pOwner.
+class StreamBuilder : public DocVisitor
+{
+public:
+  StreamBuilder(std::shared_ptr<const void> pOwner,
+                std::string_view pBytes,
+                std::pmr::memory_resource* pMemory,
+                Doc::Handler pOnDocument);
+
+  void onDocumentStart() override;
+  void onDocumentEnd() override;
+  void onMappingStart(std::string_view pPath) override;
+  void onMappingEnd(std::string_view pPath) override;
+  void onSequenceStart(std::string_view pPath) override;
+  void onSequenceEnd(std::string_view pPath) override;
+  void onKey(std::string_view pPath,
+             std::string_view pKey,
+             bool pPlain) override;
+  void onScalar(std::string_view pPath,
+                std::string_view pValue,
+                std::string_view pTag,
+                bool pPlain) override;
+  void onAnchor(std::string_view pPath, std::string_view pAnchor) override;
+  void onAlias(std::string_view pPath, std::string_view pAnchor) override;
+
+private:
+  std::shared_ptr<const void> owner;
+  std::string_view bytes;
+  std::pmr::memory_resource* memory;
+  Doc::Handler onDocument;
+  // the document being built keeps its address until it's complete
+  std::unique_ptr<Doc> document;
+  std::optional<DocBuilder> builder;
+};
+
+}
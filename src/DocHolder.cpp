@@ -0,0 +1,54 @@
+#include "DocHolder.hpp"
+
+namespace YAML {
+
+DocHolder::DocHolder()
+  : DocHolder(Doc())
+{
+}
+
+DocHolder::DocHolder(Doc pDoc)
+  : current(std::make_shared<const FrozenDoc>(std::move(pDoc)))
+{
+}
+
+std::shared_ptr<const FrozenDoc> DocHolder::get() const
+{
+  return current.load(std::memory_order_acquire);
+}
+
+void DocHolder::publish(Doc pDoc)
+{
+  publish(std::make_shared<const FrozenDoc>(std::move(pDoc)));
+}
+
+void DocHolder::publish(std::shared_ptr<const FrozenDoc> pDoc)
+{
+  if (pDoc == nullptr) {
+    return;
+  }
+
+  // the version moves after the document, a reader seeing the new version
+  // loads the new document or a later one
+  current.store(std::move(pDoc), std::memory_order_release);
+  version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+DocHolder::Reader::Reader(const DocHolder& pHolder)
+  : holder(pHolder)
+  , version(pHolder.getVersion())
+{
+  current = holder.get();
+}
+
+const Doc& DocHolder::Reader::get()
+{
+  uint64_t latest = holder.getVersion();
+  if (latest != version) {
+    version = latest;
+    current = holder.get();
+  }
+  return current->get();
+}
+
+}
@@ -0,0 +1,884 @@
+#include "DocReloader.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace YAML {
+namespace {
+size_t commonPrefix(std::string_view pA, std::string_view pB)
+{
+  // whole blocks through memcmp first, the byte loop only finds where in the
+  // last block they differ
+  constexpr size_t BLOCK = 4096;
+  size_t size = std::min(pA.size(), pB.size());
+  size_t same = 0;
+  while (same + BLOCK <= size &&
+         std::memcmp(pA.data() + same, pB.data() + same, BLOCK) == 0) {
+    same += BLOCK;
+  }
+  while (same < size && pA[same] == pB[same]) {
+    same++;
+  }
+  return same;
+}
+
+size_t commonSuffix(std::string_view pA, std::string_view pB, size_t pLimit)
+{
+  constexpr size_t BLOCK = 4096;
+  const char* a = pA.data() + pA.size();
+  const char* b = pB.data() + pB.size();
+  size_t same = 0;
+  while (same + BLOCK <= pLimit &&
+         std::memcmp(a - same - BLOCK, b - same - BLOCK, BLOCK) == 0) {
+    same += BLOCK;
+  }
+  while (same < pLimit && *(a - same - 1) == *(b - same - 1)) {
+    same++;
+  }
+  return same;
+}
+
+bool endsToken(std::string_view pText, size_t pAt)
+{
+  return pAt >= pText.size() || pText[pAt] == ' ' || pText[pAt] == '\t' ||
+         pText[pAt] == '\r' || pText[pAt] == '\n';
+}
+
+// a directive or a document marker at the start of the line at pAt
+bool isMarker(std::string_view pText, size_t pAt)
+{
+  std::string_view line = pText.substr(pAt, 3);
+  return (pAt < pText.size() && pText[pAt] == '%') ||
+         ((line == "---" || line == "...") && endsToken(pText, pAt + 3));
+}
+
+size_t lineStart(std::string_view pText, size_t pAt)
+{
+  if (pAt == 0) {
+    return 0;
+  }
+  size_t found = pText.rfind('\n', pAt - 1);
+  return found == std::string_view::npos ? 0 : found + 1;
+}
+
+size_t nextLine(std::string_view pText, size_t pAt)
+{
+  size_t found = pText.find('\n', pAt);
+  return found == std::string_view::npos ? pText.size() : found + 1;
+}
+
+// offset of pView in pText, false when it isn't a part of it
+bool offsetIn(std::string_view pText, std::string_view pView, size_t& pOut)
+{
+  auto begin = reinterpret_cast<uintptr_t>(pText.data());
+  auto at = reinterpret_cast<uintptr_t>(pView.data());
+  if (pView.empty() || at < begin ||
+      at - begin + pView.size() > pText.size()) {
+    return false;
+  }
+  pOut = at - begin;
+  return true;
+}
+
+std::string childPath(const std::string& pPath, std::string_view pName)
+{
+  return pPath.empty() ? std::string(pName)
+                       : pPath + "." + std::string(pName);
+}
+
+std::vector<const Doc*> childrenOf(const Doc& pNode)
+{
+  std::vector<const Doc*> children;
+  children.reserve(pNode.getChildCount());
+  for (const Doc* child = pNode.getFirstChild(); child;
+       child = child->getNextSibling()) {
+    children.push_back(child);
+  }
+  return children;
+}
+
+// The entries of a block mapping or sequence in the previous input, each on
+// a line of its own that opens at the same column with its key or its "-".
+struct Entries
+{
+  std::vector<const Doc*> nodes;
+  std::vector<size_t> lines;
+  size_t column = 0;
+
+  // false when pNode's entries aren't laid out that way or their text isn't
+  // a view into pSource. Entries of a nested node start below its own line,
+  // pAfter. The ones after the first opening at or past pUntil are left
+  // out.
+  bool locate(std::string_view pSource,
+              const Doc& pNode,
+              const size_t* pAfter,
+              size_t pUntil)
+  {
+    bool items = pNode.getType() == Doc::SEQUENCE;
+    for (const Doc* entry = pNode.getFirstChild(); entry;
+         entry = entry->getNextSibling()) {
+      size_t at;
+      size_t levels;
+      std::string_view name;
+      if (!firstText(pSource, *entry, items, at, levels, name)) {
+        return false;
+      }
+      // a name is kept once, as a view of the first key holding it, so a
+      // repeated one is looked for on the next line opening an entry
+      const size_t* previous = lines.empty() ? pAfter : &lines.back();
+      if (!name.empty() && previous && lineStart(pSource, at) <= *previous &&
+          !findKey(pSource, *previous, name, levels, items, at)) {
+        return false;
+      }
+
+      // the "-" of the item and of each sequence leading to its first text
+      size_t line = lineStart(pSource, at);
+      size_t opening = line;
+      while (opening < at && pSource[opening] == ' ') {
+        opening++;
+      }
+      size_t dashes = 0;
+      for (size_t i = opening; i < at; i++) {
+        if (pSource[i] == '-' && endsToken(pSource, i + 1)) {
+          dashes++;
+        } else if (pSource[i] != ' ') {
+          return false;
+        }
+      }
+      if (dashes != levels || (pAfter && line <= *pAfter) ||
+          (!lines.empty() &&
+           (opening - line != column || line <= lines.back()))) {
+        return false;
+      }
+
+      column = opening - line;
+      nodes.push_back(entry);
+      lines.push_back(line);
+      if (line >= pUntil) {
+        break;
+      }
+    }
+    return !nodes.empty();
+  }
+
+  // offset of the key of an entry, or of the first text of an item with the
+  // number of sequences it is in from there. pName is that text when it is
+  // a key.
+  static bool firstText(std::string_view pSource,
+                        const Doc& pEntry,
+                        bool pItem,
+                        size_t& pOut,
+                        size_t& pLevels,
+                        std::string_view& pName)
+  {
+    const Doc* node = &pEntry;
+    std::string_view text = node->getNameView();
+    pLevels = 0;
+    while (pItem) {
+      pLevels++;
+      const Doc* child = node->isAlias() ? nullptr : node->getFirstChild();
+      if (node->isAlias() || child == nullptr) {
+        text = node->isAlias() ? std::string_view() : node->getValueView();
+        break;
+      }
+      pItem = node->getType() == Doc::SEQUENCE;
+      node = child;
+      text = node->getNameView();
+    }
+    pName = pItem ? std::string_view() : text;
+
+    if (!offsetIn(pSource, text, pOut)) {
+      return false;
+    }
+    if (pOut > 0 && (pSource[pOut - 1] == '"' || pSource[pOut - 1] == '\'')) {
+      pOut--;
+    }
+    return true;
+  }
+
+  // offset of the key pName on the first line below pAfter opening at the
+  // column of the entries, past pLevels "-". The lines of a sequence at the
+  // column of the key holding it are skipped.
+  bool findKey(std::string_view pSource,
+               size_t pAfter,
+               std::string_view pName,
+               size_t pLevels,
+               bool pItems,
+               size_t& pOut) const
+  {
+    size_t size = pSource.size();
+    for (size_t line = nextLine(pSource, pAfter); line < size;
+         line = nextLine(pSource, line)) {
+      size_t at = line;
+      while (at < size && pSource[at] == ' ') {
+        at++;
+      }
+      if (endsToken(pSource, at) || pSource[at] == '#') {
+        continue;
+      }
+      if (!lines.empty()) {
+        if (at - line < column) {
+          return false;
+        }
+        if (at - line > column ||
+            (!pItems && pSource[at] == '-' && endsToken(pSource, at + 1))) {
+          continue;
+        }
+      }
+
+      for (size_t level = 0; level < pLevels; level++) {
+        if (at >= size || pSource[at] != '-' || !endsToken(pSource, at + 1)) {
+          return false;
+        }
+        at++;
+        while (at < size && pSource[at] == ' ') {
+          at++;
+        }
+      }
+      char quote = at < size && (pSource[at] == '"' || pSource[at] == '\'')
+                     ? pSource[at]
+                     : 0;
+      size_t end = at + (quote != 0) + pName.size();
+      if (pSource.compare(at + (quote != 0), pName.size(), pName) != 0 ||
+          (quote && (end >= size || pSource[end++] != quote))) {
+        return false;
+      }
+      while (end < size && pSource[end] == ' ') {
+        end++;
+      }
+      if (end >= size || pSource[end] != ':' || !endsToken(pSource, end + 1)) {
+        return false;
+      }
+      pOut = at;
+      return true;
+    }
+    return false;
+  }
+};
+
+// whether two subtrees hold the same content, the names of their roots
+// aside and aliases compared by their own content only
+bool sameContent(const Doc& pA, const Doc& pB)
+{
+  std::vector<std::pair<const Doc*, const Doc*>> pending = { { &pA, &pB } };
+  while (!pending.empty()) {
+    auto [a, b] = pending.back();
+    pending.pop_back();
+    if (a->getType() != b->getType() || a->isAlias() != b->isAlias() ||
+        a->getScalarKind() != b->getScalarKind() ||
+        a->getValueView() != b->getValueView() ||
+        a->getChildCount() != b->getChildCount() ||
+        (a != &pA && a->getNameView() != b->getNameView())) {
+      return false;
+    }
+    if (a->isAlias()) {
+      continue;
+    }
+
+    const Doc* childB = b->getFirstChild();
+    for (const Doc* childA = a->getFirstChild(); childA;
+         childA = childA->getNextSibling()) {
+      pending.push_back({ childA, childB });
+      childB = childB->getNextSibling();
+    }
+  }
+  return true;
+}
+
+// Pairs of nodes left to compare, walked without recursion. Mappings are
+// matched by key. Sequences by index once the items equal at both ends are
+// set aside, so that an inserted item is added rather than all the items
+// after it modified. Aliases are compared by their own content only, what
+// changes below them shows at the path of their anchored node.
+class Comparison
+{
+public:
+  Comparison(DocChanges& pChanges)
+    : changes(pChanges)
+  {
+  }
+
+  void run(const Doc& pBefore, const Doc& pAfter, const std::string& pPath)
+  {
+    pending.push_back({ &pBefore, &pAfter, pPath });
+    drain();
+  }
+
+  void drain()
+  {
+    while (!pending.empty()) {
+      Pair pair = std::move(pending.back());
+      pending.pop_back();
+      step(*pair.before, *pair.after, pair.path);
+    }
+  }
+
+  void entries(const std::vector<const Doc*>& pBefore,
+               const std::vector<const Doc*>& pAfter,
+               const std::string& pPath)
+  {
+    // a table on each side once the mappings are wide enough to need one
+    std::unordered_map<std::string_view, const Doc*> before, after;
+    bool wide =
+      std::max(pBefore.size(), pAfter.size()) >= ChildIndex::THRESHOLD;
+    if (wide) {
+      for (const Doc* entry : pBefore) {
+        before.try_emplace(entry->getNameView(), entry);
+      }
+      for (const Doc* entry : pAfter) {
+        after.try_emplace(entry->getNameView(), entry);
+      }
+    }
+
+    auto find = [&](const std::vector<const Doc*>& pEntries,
+                    const std::unordered_map<std::string_view, const Doc*>&
+                      pTable,
+                    std::string_view pName) -> const Doc* {
+      if (wide) {
+        auto found = pTable.find(pName);
+        return found == pTable.end() ? nullptr : found->second;
+      }
+      for (const Doc* entry : pEntries) {
+        if (entry->getNameView() == pName) {
+          return entry;
+        }
+      }
+      return nullptr;
+    };
+
+    for (const Doc* entry : pBefore) {
+      const Doc* match = find(pAfter, after, entry->getNameView());
+      if (match == nullptr) {
+        changes.removed.push_back(childPath(pPath, entry->getNameView()));
+      } else {
+        pending.push_back(
+          { entry, match, childPath(pPath, entry->getNameView()) });
+      }
+    }
+    for (const Doc* entry : pAfter) {
+      if (find(pBefore, before, entry->getNameView()) == nullptr) {
+        changes.added.push_back(childPath(pPath, entry->getNameView()));
+      }
+    }
+  }
+
+  // pBefore and pAfter are the items of a sequence from index pFirst on
+  void items(const std::vector<const Doc*>& pBefore,
+             const std::vector<const Doc*>& pAfter,
+             const std::string& pPath,
+             size_t pFirst)
+  {
+    size_t shorter = std::min(pBefore.size(), pAfter.size());
+    size_t head = 0;
+    while (head < shorter && sameContent(*pBefore[head], *pAfter[head])) {
+      head++;
+    }
+    size_t tail = 0;
+    while (head + tail < shorter &&
+           sameContent(*pBefore[pBefore.size() - 1 - tail],
+                       *pAfter[pAfter.size() - 1 - tail])) {
+      tail++;
+    }
+
+    auto path = [&](size_t pIndex) {
+      return childPath(pPath, std::to_string(pFirst + pIndex));
+    };
+    size_t index = head;
+    for (; index + tail < shorter; index++) {
+      pending.push_back({ pBefore[index], pAfter[index], path(index) });
+    }
+    for (size_t i = index; i + tail < pBefore.size(); i++) {
+      changes.removed.push_back(path(i));
+    }
+    for (size_t i = index; i + tail < pAfter.size(); i++) {
+      changes.added.push_back(path(i));
+    }
+  }
+
+private:
+  struct Pair
+  {
+    const Doc* before;
+    const Doc* after;
+    std::string path;
+  };
+
+  void step(const Doc& pBefore, const Doc& pAfter, const std::string& pPath)
+  {
+    if (pBefore.getType() != pAfter.getType() ||
+        pBefore.isAlias() != pAfter.isAlias()) {
+      changes.modified.push_back(pPath);
+      return;
+    }
+
+    if (pBefore.isAlias()) {
+      if (pBefore.getValueView() != pAfter.getValueView() ||
+          pBefore.getChildCount() != pAfter.getChildCount()) {
+        changes.modified.push_back(pPath);
+      }
+      return;
+    }
+
+    if (pBefore.getChildCount() == 0 && pAfter.getChildCount() == 0) {
+      if (pBefore.getValueView() != pAfter.getValueView() ||
+          pBefore.getScalarKind() != pAfter.getScalarKind()) {
+        changes.modified.push_back(pPath);
+      }
+      return;
+    }
+
+    if (pBefore.getType() == Doc::SEQUENCE) {
+      items(childrenOf(pBefore), childrenOf(pAfter), pPath, 0);
+    } else {
+      entries(childrenOf(pBefore), childrenOf(pAfter), pPath);
+    }
+  }
+
+  DocChanges& changes;
+  std::vector<Pair> pending;
+};
+}
+
+Doc Doc::reloadString(const Doc& pPrevious,
+                      std::string pString,
+                      DocChanges* pChanges)
+{
+  auto content = std::make_shared<std::string>(std::move(pString));
+  std::string_view bytes = *content;
+  return DocReloader::reload(pPrevious, std::move(content), bytes, pChanges);
+}
+
+Doc Doc::reloadFile(const Doc& pPrevious,
+                    const std::string& pPath,
+                    DocChanges* pChanges)
+{
+  std::shared_ptr<MappedFile> file = MappedFile::open(pPath, false);
+  std::string_view bytes = file->getBytes();
+  Doc doc = DocReloader::reload(pPrevious, file, bytes, pChanges);
+  file->adviseSequential(false);
+  return doc;
+}
+
+Doc DocReloader::reload(const Doc& pPrevious,
+                        std::shared_ptr<const void> pOwner,
+                        std::string_view pBytes,
+                        DocChanges* pChanges)
+{
+  // the new document allocates from the same resource as pPrevious
+  ParseOptions options;
+  options.memory = pPrevious.getMemoryResource();
+
+  DocChanges changes;
+  Doc doc;
+  doc.initRoot(pOwner, pBytes, options.memory);
+  if (reloadEntries(
+        pPrevious, pOwner, pBytes, doc, pChanges ? &changes : nullptr)) {
+    doc.arena->setSource(pBytes);
+  } else {
+    // parse errors are reported from here, with their place in the input
+    changes.clear();
+    doc = Doc::parseBuffer(std::move(pOwner), pBytes, options);
+    if (pChanges) {
+      compare(pPrevious, doc, "", changes);
+    }
+  }
+
+  if (pChanges) {
+    auto append = [](std::vector<std::string>& pTo,
+                     std::vector<std::string>& pFrom) {
+      std::sort(pFrom.begin(), pFrom.end());
+      pTo.insert(pTo.end(),
+                 std::make_move_iterator(pFrom.begin()),
+                 std::make_move_iterator(pFrom.end()));
+    };
+    append(pChanges->added, changes.added);
+    append(pChanges->removed, changes.removed);
+    append(pChanges->modified, changes.modified);
+  }
+  return doc;
+}
+
+void DocReloader::compare(const Doc& pBefore,
+                          const Doc& pAfter,
+                          const std::string& pPath,
+                          DocChanges& pChanges)
+{
+  Comparison(pChanges).run(pBefore, pAfter, pPath);
+}
+
+template<typename Text>
+bool DocReloader::copyEntry(Doc& pTarget,
+                            const Doc& pEntry,
+                            uint32_t pKey,
+                            Text pText)
+{
+  // preorder walk following sibling and parent links, as copyChildren()
+  Doc* target = &pTarget;
+  const Doc* current = &pEntry;
+  while (true) {
+    if (current->isAlias()) {
+      return false;
+    }
+
+    Doc* copy = current == &pEntry
+                  ? target->appendChild(pKey)
+                  : target->appendChild(current->getNameView());
+    copy->type = current->type;
+    copy->kind = current->kind;
+    copy->number = current->number;
+    copy->value = pText(current->value);
+
+    if (current->firstChild != DocArena::NO_NODE) {
+      target = copy;
+      current = current->node(current->firstChild);
+      continue;
+    }
+
+    // the copy of a parent is complete once its last child is
+    while (current != &pEntry && current->nextSibling == DocArena::NO_NODE) {
+      current = current->getParent();
+      target = target->getParent();
+      Doc* complete = target->node(target->lastChild);
+      if (complete->childCount >= ChildIndex::THRESHOLD) {
+        complete->buildIndex();
+      }
+    }
+    if (current == &pEntry) {
+      return true;
+    }
+    current = current->node(current->nextSibling);
+  }
+}
+
+bool DocReloader::reloadEntries(const Doc& pPrevious,
+                                const std::shared_ptr<const void>& pOwner,
+                                std::string_view pBytes,
+                                Doc& pOut,
+                                DocChanges* pChanges)
+{
+  if (!pPrevious.ownsArena() || pPrevious.arena == nullptr ||
+      pPrevious.type != Doc::MAPPING) {
+    return false;
+  }
+  std::string_view source = pPrevious.arena->getSource();
+  if (source.empty()) {
+    return false;
+  }
+
+  // the edited bytes, [prefix, source.size() - suffix) before and
+  // [prefix, pBytes.size() - suffix) after. Entries are only located up to
+  // the first one opening after the line the edit ends on.
+  size_t prefix = commonPrefix(source, pBytes);
+  size_t suffix = commonSuffix(
+    source, pBytes, std::min(source.size(), pBytes.size()) - prefix);
+  size_t editEnd = source.size() - suffix;
+  size_t until = nextLine(source, editEnd);
+  Entries entries;
+  if (!entries.locate(source, pPrevious, nullptr, until)) {
+    return false;
+  }
+
+  // The edit widened to whole entries of a node, [first, last): from the one
+  // whose opening is the last unchanged before the edit to the first one
+  // opening after it, so that the reparsed text starts and ends on lines
+  // both inputs share. Only the root may be reparsed to the end of its
+  // region, none from the start of the input, which decides what the
+  // document holds.
+  struct Span
+  {
+    size_t first;
+    size_t last;
+    size_t begin;
+    size_t end;
+  };
+  auto widen = [&](const Entries& pEntries, size_t pEnd, bool pRoot,
+                   Span& pSpan) {
+    const std::vector<size_t>& lines = pEntries.lines;
+    auto opened = std::partition_point(
+      lines.begin(), lines.end(), [&](size_t pLine) {
+        return pLine + pEntries.column < prefix;
+      });
+    if (opened == lines.begin()) {
+      return false;
+    }
+    pSpan.first = opened - lines.begin() - 1;
+    pSpan.begin = lines[pSpan.first];
+
+    if (editEnd >= pEnd) {
+      if (!pRoot) {
+        return false;
+      }
+      pSpan.last = lines.size();
+      pSpan.end = pEnd;
+    } else {
+      pSpan.last =
+        std::lower_bound(lines.begin(), lines.end(), until) - lines.begin();
+      pSpan.end = pSpan.last < lines.size() ? lines[pSpan.last] : pEnd;
+    }
+    return true;
+  };
+
+  // down to the innermost node holding the edit within one of its entries
+  std::vector<const Doc*> chain = { &pPrevious };
+  Span span;
+  size_t regionBegin = 0;
+  size_t regionEnd = source.size();
+  if (!widen(entries, regionEnd, true, span)) {
+    return false;
+  }
+  while (span.last == span.first + 1) {
+    const Doc* entry = entries.nodes[span.first];
+    Entries inner;
+    Span innerSpan;
+    if (entry->isAlias() ||
+        (entry->type != Doc::MAPPING && entry->type != Doc::SEQUENCE) ||
+        !inner.locate(source, *entry, &entries.lines[span.first], until) ||
+        !widen(inner, span.end, false, innerSpan)) {
+      break;
+    }
+    chain.push_back(entry);
+    regionBegin = span.begin;
+    regionEnd = span.end;
+    entries = std::move(inner);
+    span = innerSpan;
+  }
+  const Doc& node = *chain.back();
+  if (span.begin == 0) {
+    return false;
+  }
+
+  // every node outside of the reparsed text is copied, which costs about a
+  // third of their parse, so reparsing more than half of the input isn't
+  // cheaper than a full parse
+  std::string_view text = pBytes.substr(
+    span.begin, span.end + pBytes.size() - source.size() - span.begin);
+  if (text.size() > pBytes.size() / 2) {
+    return false;
+  }
+
+  // merge keys add entries depending on the other keys of their mapping
+  std::string_view region =
+    source.substr(regionBegin, regionEnd - regionBegin);
+  if (region.find("<<") != std::string_view::npos) {
+    return false;
+  }
+
+  // every line of the reparsed text must belong to the node, the first one
+  // at its column. A marker ends the document and a line of node properties
+  // applies to what follows it, which the part alone can't tell.
+  size_t opening = text.size();
+  for (size_t at = 0; at < text.size(); at = nextLine(text, at)) {
+    size_t indent = at;
+    while (indent < text.size() && text[indent] == ' ') {
+      indent++;
+    }
+    if (endsToken(text, indent) || text[indent] == '#') {
+      continue;
+    }
+    if (isMarker(text, at) || text[indent] == '&' || text[indent] == '!' ||
+        indent - at < entries.column ||
+        (opening == text.size() && indent - at != entries.column)) {
+      return false;
+    }
+    opening = std::min(opening, at);
+  }
+
+  Doc part;
+  if (text.find("<<") != std::string_view::npos) {
+    return false;
+  }
+  try {
+    // its names and values are views of the text, as in a full parse
+    part = Doc::parseBuffer(pOwner, text, ParseOptions());
+  } catch (const DocException&) {
+    return false;
+  }
+  // an edit may remove its entries, not all the entries of the node. An
+  // empty quoted scalar is content all the same.
+  bool emptied = part.type == Doc::NONE;
+  if (part.type != node.type &&
+      (!emptied || (span.first == 0 && span.last == node.childCount))) {
+    return false;
+  }
+  // parsed alone, the text may hold what it can't in its place, a flow
+  // collection or entries at another column. Its entries must open lines at
+  // the column of the node's, from its first one.
+  Entries parts;
+  if (!emptied && (!parts.locate(text, part, nullptr, text.size()) ||
+                   parts.column != entries.column ||
+                   parts.lines.front() != opening)) {
+    return false;
+  }
+
+  // Arena order is document order, as after a parse, so the replaced entries
+  // hold the nodes [dropBegin, dropEnd) and the reparsed ones take their
+  // place. Nodes after them move by the difference.
+  const Doc* tailHead =
+    span.last < entries.nodes.size() ? entries.nodes[span.last] : nullptr;
+  uint32_t dropEnd = pPrevious.arena->size();
+  if (tailHead) {
+    dropEnd = tailHead->index;
+  } else {
+    for (const Doc* current = &node; current != &pPrevious;
+         current = current->getParent()) {
+      if (current->nextSibling != DocArena::NO_NODE) {
+        dropEnd = current->nextSibling;
+        break;
+      }
+    }
+  }
+  uint32_t dropBegin = span.first < span.last
+                         ? entries.nodes[span.first]->index
+                         : dropEnd;
+
+  uint32_t partSize = part.arena ? part.arena->size() : 0;
+  auto renumber = [&](uint32_t pIndex) {
+    if (pIndex >= DocArena::ROOT_NODE || pIndex < dropBegin) {
+      return pIndex;
+    }
+    return pIndex - (dropEnd - dropBegin) + partSize;
+  };
+
+  // text before the edit keeps its offset, text after it moves with the
+  // length of the edit
+  DocArena* arena = pOut.arena;
+  auto moved = [&](std::string_view pText) {
+    size_t at;
+    if (offsetIn(source, pText, at)) {
+      if (at + pText.size() <= span.begin) {
+        return pBytes.substr(at, pText.size());
+      }
+      if (at >= span.end) {
+        return pBytes.substr(at + pBytes.size() - source.size(), pText.size());
+      }
+    }
+    return pText.empty() ? pText : arena->storeString(pText);
+  };
+  auto adopted = [&](std::string_view pText) {
+    return arena->adoptString(pText);
+  };
+
+  // nodes are cloned in arena order, as a snapshot is loaded, keeping the
+  // links between them and their child indexes. Aliases could point into the
+  // edit.
+  auto clone = [&](Doc& pTo, const Doc& pFrom) {
+    pTo.type = pFrom.type;
+    pTo.kind = pFrom.kind;
+    pTo.number = pFrom.number;
+    pTo.key = pFrom.key;
+    pTo.value = moved(pFrom.value);
+    pTo.parent = renumber(pFrom.parent);
+    pTo.firstChild = renumber(pFrom.firstChild);
+    pTo.lastChild = renumber(pFrom.lastChild);
+    pTo.nextSibling = renumber(pFrom.nextSibling);
+    pTo.childCount = pFrom.childCount;
+    if (pFrom.childIndex != DocArena::NO_NODE && &pFrom != &node) {
+      pTo.childIndex = arena->createIndex();
+      ChildIndex& table = arena->getIndex(pTo.childIndex);
+      table = pPrevious.arena->getIndex(pFrom.childIndex);
+      table.renumber(renumber);
+    }
+  };
+  auto cloneRange = [&](uint32_t pBegin, uint32_t pEnd) {
+    uint32_t first = arena->allocate(pEnd - pBegin);
+    // in runs of nodes that are contiguous in both arenas
+    for (uint32_t i = pBegin; i < pEnd;) {
+      uint32_t chunk, offset, toChunk, toOffset;
+      DocArena::locate(i, chunk, offset);
+      DocArena::locate(first + i - pBegin, toChunk, toOffset);
+      size_t run = std::min({ size_t(pEnd - i),
+                              DocArena::chunkCapacity(chunk) - offset,
+                              DocArena::chunkCapacity(toChunk) - toOffset });
+      const Doc* from = pPrevious.arena->getChunk(chunk) + offset;
+      Doc* to = arena->getChunk(toChunk) + toOffset;
+      for (size_t k = 0; k < run; k++) {
+        if (from[k].isAlias()) {
+          return false;
+        }
+        to[k].arena = arena;
+        to[k].index = renumber(i + k);
+        clone(to[k], from[k]);
+      }
+      i += run;
+    }
+    return true;
+  };
+
+  // keys keep their ids, the nodes cloned keep their names
+  arena->copyKeys(*pPrevious.arena, moved);
+  clone(pOut, pPrevious);
+  if (dropBegin > dropEnd || !cloneRange(0, dropBegin)) {
+    return false;
+  }
+
+  // the reparsed entries after the ones kept before the edit
+  Doc* edited = chain.size() == 1 ? &pOut : pOut.node(node.index);
+  bool items = node.type == Doc::SEQUENCE;
+  uint32_t tailEnd = edited->lastChild;
+  edited->childCount = span.first;
+  edited->lastChild = span.first > 0 ? entries.nodes[span.first - 1]->index
+                                     : DocArena::NO_NODE;
+  if (edited->lastChild == DocArena::NO_NODE) {
+    edited->firstChild = DocArena::NO_NODE;
+  } else {
+    edited->node(edited->lastChild)->nextSibling = DocArena::NO_NODE;
+  }
+  for (const Doc* entry = part.getFirstChild(); entry;
+       entry = entry->getNextSibling()) {
+    uint32_t key = items ? arena->itemKey(edited->childCount)
+                         : arena->internKey(entry->getNameView());
+    if (!copyEntry(*edited, *entry, key, adopted)) {
+      return false;
+    }
+  }
+  // the part's root isn't in its arena, the nodes of its entries are
+  if (arena->size() != dropBegin + partSize ||
+      !cloneRange(dropEnd, pPrevious.arena->size())) {
+    return false;
+  }
+
+  if (tailHead) {
+    uint32_t tail = renumber(tailHead->index);
+    // items after the edit are named after their new index
+    if (items && edited->childCount != span.last) {
+      uint32_t index = edited->childCount;
+      for (uint32_t i = tail; i != DocArena::NO_NODE;
+           i = edited->node(i)->nextSibling) {
+        edited->node(i)->key = arena->itemKey(index++);
+      }
+    }
+    if (edited->lastChild == DocArena::NO_NODE) {
+      edited->firstChild = tail;
+    } else {
+      edited->node(edited->lastChild)->nextSibling = tail;
+    }
+    edited->lastChild = tailEnd;
+    edited->childCount += node.childCount - span.last;
+  }
+  if (edited->childCount >= ChildIndex::THRESHOLD) {
+    edited->buildIndex();
+  }
+
+  if (pChanges) {
+    std::string path;
+    for (size_t level = 1; level < chain.size(); level++) {
+      path = childPath(path, chain[level]->getNameView());
+    }
+
+    std::vector<const Doc*> edited(entries.nodes.begin() + span.first,
+                                   entries.nodes.begin() + span.last);
+    Comparison comparison(*pChanges);
+    if (node.type == Doc::SEQUENCE) {
+      comparison.items(edited, childrenOf(part), path, span.first);
+    } else {
+      comparison.entries(edited, childrenOf(part), path);
+    }
+    comparison.drain();
+  }
+  return true;
+}
+
+}
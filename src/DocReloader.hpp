@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Doc.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace YAML {
+
+// Builds the next version of a parsed document from its edited input. The
+// bytes both inputs share at their start and end are skipped, the edit in
+// between is widened to whole entries of the innermost block mapping or
+// sequence holding it, each opening a line of its own, and only those are
+// parsed. The rest of the tree is copied from the previous one with names and
+// values pointed at the same text in the new input, so nothing of the
+// previous input is retained.
+class DocReloader
+{
+public:
+  static Doc reload(const Doc& pPrevious,
+                    std::shared_ptr<const void> pOwner,
+                    std::string_view pBytes,
+                    DocChanges* pChanges);
+
+  // adds to pChanges what differs from pBefore to pAfter, both at pPath
+  static void compare(const Doc& pBefore,
+                      const Doc& pAfter,
+                      const std::string& pPath,
+                      DocChanges& pChanges);
+
+private:
+  // false when the edit can't be isolated to whole entries. pBytes are
+  // retained through pOwner.
+  static bool reloadEntries(const Doc& pPrevious,
+                            const std::shared_ptr<const void>& pOwner,
+                            std::string_view pBytes,
+                            Doc& pOut,
+                            DocChanges* pChanges);
+
+  // appends a copy of pEntry named pKey and its subtree to pTarget, values
+  // going through pText. False on aliases, whose targets aren't copied.
+  template<typename Text>
+  static bool copyEntry(Doc& pTarget,
+                        const Doc& pEntry,
+                        uint32_t pKey,
+                        Text pText);
+};
+
+}
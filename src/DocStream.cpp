@@ -0,0 +1,206 @@
+#include "BlockScanner.hpp"
+#include "Doc.hpp"
+#include "DocBuilder.hpp"
+#include "EventReader.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace YAML {
+namespace {
+// start of the first "---" line at or after pFrom, or the end of pBytes
+size_t findDocumentStart(std::string_view pBytes, size_t pFrom)
+{
+  const std::string_view separators(" \t\r\n");
+  if (pFrom == 0) {
+    if (pBytes.starts_with("---") &&
+        (pBytes.size() == 3 ||
+         separators.find(pBytes[3]) != std::string_view::npos)) {
+      return 0;
+    }
+    pFrom = 1;
+  }
+
+  size_t marker = pFrom - 1;
+  while ((marker = pBytes.find("\n---", marker)) != std::string_view::npos) {
+    size_t after = marker + 4;
+    if (after == pBytes.size() ||
+        separators.find(pBytes[after]) != std::string_view::npos) {
+      return marker + 1;
+    }
+    marker = after;
+  }
+
+  return pBytes.size();
+}
+
+// Cuts a stream at document markers into sections of at least pMinSize
+// bytes. A marker can't appear inside a scalar, so every section parses on
+// its own, except when directives are used: they belong to the document
+// after them and the stream is kept whole.
+std::vector<std::string_view> splitDocuments(std::string_view pBytes,
+                                             size_t pMinSize)
+{
+  if (pBytes.starts_with('%') ||
+      pBytes.find("\n%") != std::string_view::npos) {
+    return { pBytes };
+  }
+
+  std::vector<std::string_view> sections;
+  size_t begin = 0;
+  while (begin < pBytes.size()) {
+    size_t end =
+      findDocumentStart(pBytes, begin + std::max<size_t>(pMinSize, 1));
+    sections.push_back(pBytes.substr(begin, end - begin));
+    begin = end;
+  }
+
+  return sections;
+}
+}
+
+std::vector<Doc> Doc::parseAllFile(const std::string& pPath)
+{
+  return parseAllFile(pPath, ParseOptions());
+}
+
+std::vector<Doc> Doc::parseAllFile(const std::string& pPath,
+                                   const ParseOptions& pOptions)
+{
+  std::shared_ptr<MappedFile> file =
+    MappedFile::open(pPath, pOptions.mapFile);
+  std::vector<Doc> docs = parseStream(file, file->getBytes(), pOptions);
+  file->adviseSequential(false);
+  return docs;
+}
+
+std::vector<Doc> Doc::parseAllString(const std::string& pString)
+{
+  return parseAllString(pString, ParseOptions());
+}
+
+std::vector<Doc> Doc::parseAllString(std::string&& pString)
+{
+  auto content = std::make_shared<std::string>(std::move(pString));
+  std::string_view bytes = *content;
+  return parseStream(std::move(content), bytes, ParseOptions());
+}
+
+std::vector<Doc> Doc::parseAllString(const std::string& pString,
+                                     const ParseOptions& pOptions)
+{
+  auto content = std::make_shared<std::string>(pString);
+  std::string_view bytes = *content;
+  return parseStream(std::move(content), bytes, pOptions);
+}
+
+std::vector<Doc> Doc::parseStream(std::shared_ptr<const void> pOwner,
+                                  std::string_view pBytes,
+                                  const ParseOptions& pOptions)
+{
+  unsigned threads = pOptions.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::vector<Doc> docs;
+  if (threads == 1 || pBytes.size() < ParseOptions::PARALLEL_THRESHOLD) {
+    parseDocuments(pOwner, pBytes, pOptions, docs);
+    return docs;
+  }
+
+  // a few chunks per thread evens out documents of different sizes
+  std::vector<std::string_view> chunks =
+    splitDocuments(pBytes, pBytes.size() / (threads * 4));
+  std::vector<std::vector<Doc>> results(chunks.size());
+  std::vector<std::exception_ptr> errors(chunks.size());
+
+  std::atomic<size_t> nextChunk = 0;
+  auto work = [&]() {
+    for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+      try {
+        parseDocuments(pOwner, chunks[i], pOptions, results[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  size_t workerCount = std::min<size_t>(threads, chunks.size());
+  for (size_t i = 1; i < workerCount; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  // report the error a serial parse would have met first
+  size_t total = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    if (errors[i]) {
+      std::rethrow_exception(errors[i]);
+    }
+    total += results[i].size();
+  }
+
+  docs.reserve(total);
+  for (std::vector<Doc>& result : results) {
+    for (Doc& doc : result) {
+      docs.push_back(std::move(doc));
+    }
+  }
+  return docs;
+}
+
+void Doc::parseAllInput(const Reader& pRead,
+                        const Handler& pOnDocument,
+                        const ParseOptions& pOptions)
+{
+  // nothing is retained, the builder copies every scalar into its document
+  StreamBuilder builder(nullptr, std::string_view(), pOptions.memory,
+                        pOnDocument);
+  EventReader(builder).readInput(pRead);
+}
+
+void Doc::parseAllInput(std::istream& pInput,
+                        const Handler& pOnDocument,
+                        const ParseOptions& pOptions)
+{
+  parseAllInput(streamReader(pInput), pOnDocument, pOptions);
+}
+
+void Doc::parseDocuments(const std::shared_ptr<const void>& pOwner,
+                         std::string_view pBytes,
+                         const ParseOptions& pOptions,
+                         std::vector<Doc>& pOut)
+{
+  for (std::string_view section : splitDocuments(pBytes, 0)) {
+    // the block scanner takes a document opened by a bare "---" line
+    std::string_view body = section;
+    if (body.starts_with("---\n") || body == "---") {
+      body.remove_prefix(std::min<size_t>(body.size(), 4));
+    }
+
+    if (pOptions.fastScan) {
+      Doc doc;
+      doc.initRoot(pOwner, section, pOptions.memory);
+      if (BlockScanner::build(body, doc) && doc.type != NONE) {
+        pOut.push_back(std::move(doc));
+        continue;
+      }
+    }
+
+    StreamBuilder builder(
+      pOwner, section, pOptions.memory, [&](Doc&& pDoc) {
+        pOut.push_back(std::move(pDoc));
+      });
+    EventReader(builder).readString(section);
+  }
+}
+
+}
@@ -0,0 +1,366 @@
+#include "DocWriter.hpp"
+#include "Doc.hpp"
+
+#include "exceptions/DocNodeException.hpp"
+
+#include <cstring>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace YAML {
+namespace {
+// libyaml's limit on the length of a simple key
+constexpr size_t MAX_KEY_LENGTH = 1024;
+
+// line breaks and byte order mark beyond ASCII, length of the sequence
+// starting at pText[pAt] or 0
+size_t specialBreak(std::string_view pText, size_t pAt)
+{
+  std::string_view rest = pText.substr(pAt);
+  if (rest.starts_with("\xC2\x85")) {
+    return 2;
+  }
+  if (rest.starts_with("\xE2\x80\xA8") || rest.starts_with("\xE2\x80\xA9") ||
+      rest.starts_with("\xEF\xBB\xBF")) {
+    return 3;
+  }
+  return 0;
+}
+
+// whether pText reads back as itself when written as a plain scalar
+bool isPlain(std::string_view pText)
+{
+  if (pText.empty() || pText.front() == ' ' || pText.back() == ' ' ||
+      pText.starts_with("---") || pText.starts_with("...")) {
+    return false;
+  }
+
+  char first = pText.front();
+  if (std::strchr("?:,[]{}#&*!|>'\"%@`", first) != nullptr ||
+      (first == '-' && (pText.size() == 1 || pText[1] == ' '))) {
+    return false;
+  }
+
+  for (size_t i = 0; i < pText.size(); i++) {
+    unsigned char character = pText[i];
+    if (character < 0x20 || character == 0x7F ||
+        (character == ':' && (i + 1 == pText.size() || pText[i + 1] == ' ')) ||
+        (character == '#' && pText[i - 1] == ' ') ||
+        (character >= 0x80 && specialBreak(pText, i) != 0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Preorder walk below pRoot, without recursion since the children of an
+// expanded alias don't link back to it. pEnter(node, parent, depth,
+// expanding) tells whether to walk the node's children.
+template<typename Enter>
+void walk(const Doc& pRoot, bool pExpanding, Enter pEnter)
+{
+  struct Frame
+  {
+    const Doc* node;
+    const Doc* next;
+    bool expanding;
+  };
+
+  std::vector<Frame> stack = { { &pRoot, pRoot.getFirstChild(), pExpanding } };
+  size_t budget = Doc::MAX_ALIAS_EXPANSION;
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    if (top.next == nullptr) {
+      stack.pop_back();
+      continue;
+    }
+
+    const Doc* parent = top.node;
+    const Doc* child = top.next;
+    bool expanding = top.expanding;
+    top.next = child->getNextSibling();
+
+    if (expanding && budget-- == 0) {
+      throw DocNodeException("Expanding the aliases of " +
+                             pRoot.getName() + " creates more than " +
+                             std::to_string(Doc::MAX_ALIAS_EXPANSION) +
+                             " nodes.");
+    }
+
+    if (pEnter(*child, *parent, stack.size(), expanding)) {
+      stack.push_back(
+        { child, child->getFirstChild(), expanding || child->isAlias() });
+    }
+  }
+}
+}
+
+DocWriter::DocWriter(std::ostream& pOut)
+  : DocWriter([&pOut](std::string_view pText) {
+    pOut.write(pText.data(), pText.size());
+  })
+{
+}
+
+DocWriter::DocWriter(Sink pSink)
+  : sink(std::move(pSink))
+{
+  buffer.reserve(BUFFER_SIZE);
+}
+
+DocWriter::~DocWriter()
+{
+  flush();
+}
+
+void DocWriter::flush()
+{
+  if (!buffer.empty()) {
+    sink(buffer);
+    buffer.clear();
+  }
+}
+
+void DocWriter::writeTree(const Doc& pNode, int pDepth)
+{
+  auto line = [&](const Doc& pLine, size_t pLineDepth) {
+    if (pLineDepth > 0) {
+      put('|');
+      for (size_t i = 1; i < pLineDepth; i++) {
+        put("--");
+      }
+      put(' ');
+    }
+
+    put(pLine.getNameView());
+    if (pLine.getChildCount() == 0) {
+      put(" -> ");
+      put(pLine.value);
+    }
+    put('\n');
+  };
+
+  line(pNode, pDepth);
+  walk(pNode,
+       pNode.isAlias(),
+       [&](const Doc& pChild, const Doc&, size_t pLevel, bool) {
+         line(pChild, pDepth + pLevel);
+         return true;
+       });
+}
+
+void DocWriter::writeYaml(const Doc& pNode)
+{
+  // anchored nodes of the aliases found below pNode, numbered once written
+  std::unordered_map<const Doc*, uint32_t> anchors;
+  walk(pNode, false, [&](const Doc& pChild, const Doc&, size_t, bool) {
+    if (pChild.isAlias()) {
+      anchors.try_emplace(pChild.content(), 0);
+    }
+    return !pChild.isAlias();
+  });
+  uint32_t anchorCount = 0;
+
+  if (pNode.getChildCount() == 0) {
+    if (pNode.type == Doc::SEQUENCE) {
+      put("[]\n");
+    } else if (pNode.type == Doc::MAPPING) {
+      put("{}\n");
+    } else if (pNode.type == Doc::NONE) {
+      return;
+    } else if (!pNode.value.empty() || pNode.kind != Scalar::NULL_VALUE) {
+      writeScalar(pNode);
+      put('\n');
+    } else if (pNode.type == Doc::SCALAR) {
+      // an empty document rather than none
+      put("---\n");
+    }
+    return;
+  }
+
+  // the cursor already sits where the next entry starts, after "- "
+  bool inlined = false;
+  walk(pNode,
+       pNode.isAlias(),
+       [&](const Doc& pChild,
+           const Doc& pParent,
+           size_t pDepth,
+           bool pExpanding) {
+         size_t indent = 2 * (pDepth - 1);
+         if (!inlined) {
+           writeIndent(indent);
+         }
+         inlined = false;
+
+         if (pParent.type == Doc::SEQUENCE) {
+           put('-');
+         } else if (pChild.getNameView().size() > MAX_KEY_LENGTH) {
+           put("? ");
+           writeKey(pChild.getNameView());
+           put('\n');
+           writeIndent(indent);
+           put(':');
+         } else {
+           writeKey(pChild.getNameView());
+           put(':');
+         }
+
+         auto found = anchors.empty() ? anchors.end()
+                                      : anchors.find(pChild.content());
+         if (pChild.isAlias() && found != anchors.end() && found->second) {
+           put(" *a");
+           put(std::to_string(found->second));
+           put('\n');
+           return false;
+         }
+
+         // nodes reached through an expanded alias are copies, not anchored
+         bool anchored =
+           found != anchors.end() && !pChild.isAlias() && !pExpanding;
+         if (anchored) {
+           found->second = ++anchorCount;
+           put(" &a");
+           put(std::to_string(found->second));
+         }
+
+         if (pChild.getChildCount() == 0) {
+           if (pChild.type == Doc::SEQUENCE) {
+             put(" []");
+           } else if (pChild.type == Doc::MAPPING) {
+             put(" {}");
+           } else if (pChild.type != Doc::NONE &&
+                      (!pChild.value.empty() ||
+                       pChild.kind != Scalar::NULL_VALUE)) {
+             put(' ');
+             writeScalar(pChild);
+           }
+           put('\n');
+           return false;
+         }
+
+         // entries of a sequence start on the line of their "-"
+         if (pParent.type == Doc::SEQUENCE && !anchored) {
+           put(' ');
+           inlined = true;
+         } else {
+           put('\n');
+         }
+         return true;
+       });
+}
+
+void DocWriter::writeScalar(const Doc& pNode)
+{
+  std::string_view text = pNode.value;
+  int64_t integer;
+  double real;
+  bool plain = isPlain(text);
+  if (plain && Scalar::classify(text, integer, real) == pNode.kind) {
+    put(text);
+    return;
+  }
+
+  // the tag keeps the kind of scalars that would resolve to another one
+  switch (pNode.kind) {
+    case Scalar::NULL_VALUE:
+      put("!!null ");
+      break;
+    case Scalar::BOOLEAN:
+      put("!!bool ");
+      break;
+    case Scalar::INTEGER:
+      put("!!int ");
+      break;
+    case Scalar::FLOAT:
+      put("!!float ");
+      break;
+    default:
+      writeQuoted(text);
+      return;
+  }
+
+  if (plain) {
+    put(text);
+  } else {
+    writeQuoted(text);
+  }
+}
+
+void DocWriter::writeKey(std::string_view pKey)
+{
+  // merge keys are resolved when parsing, a "<<" left is a string
+  if (isPlain(pKey) && pKey != "<<") {
+    put(pKey);
+  } else {
+    writeQuoted(pKey);
+  }
+}
+
+void DocWriter::writeQuoted(std::string_view pText)
+{
+  put('"');
+
+  // runs of characters needing no escape are written at once
+  size_t run = 0;
+  for (size_t i = 0; i < pText.size();) {
+    unsigned char character = pText[i];
+    const char* escape = nullptr;
+    char hex[5];
+    size_t length = 1;
+    switch (character) {
+      case '"':
+        escape = "\\\"";
+        break;
+      case '\\':
+        escape = "\\\\";
+        break;
+      case '\n':
+        escape = "\\n";
+        break;
+      case '\t':
+        escape = "\\t";
+        break;
+      case '\r':
+        escape = "\\r";
+        break;
+      default:
+        if (character < 0x20 || character == 0x7F) {
+          std::snprintf(hex, sizeof(hex), "\\x%02X", character);
+          escape = hex;
+        } else if (character >= 0x80 && (length = specialBreak(pText, i))) {
+          static const char* const escapes[] = { "\\N", "\\L", "\\P" };
+          escape = length == 2               ? escapes[0]
+                   : pText[i + 2] == '\xA8' ? escapes[1]
+                   : pText[i + 2] == '\xA9' ? escapes[2]
+                                            : "\\uFEFF";
+        } else {
+          length = 1;
+        }
+        break;
+    }
+
+    if (escape) {
+      put(pText.substr(run, i - run));
+      put(escape);
+      run = i + length;
+    }
+    i += length;
+  }
+
+  put(pText.substr(run));
+  put('"');
+}
+
+void DocWriter::writeIndent(size_t pIndent)
+{
+  static constexpr std::string_view spaces = "                                ";
+  while (pIndent > spaces.size()) {
+    put(spaces);
+    pIndent -= spaces.size();
+  }
+  put(spaces.substr(0, pIndent));
+}
+
+}
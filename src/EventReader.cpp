@@ -0,0 +1,331 @@
+#include "EventReader.hpp"
+
+#include "exceptions/DocParserException.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <yaml.h>
+
+namespace YAML {
+namespace {
+// Maps libyaml marks, which count characters, back to byte offsets in the
+// UTF-8 input. Scalars arrive in document order so the cursor only moves
+// forward.
+class SourceCursor
+{
+public:
+  SourceCursor(std::string_view pSource)
+    : source(pSource)
+  {
+    if (source.substr(0, 3) == "\xEF\xBB\xBF") {
+      byteOffset = 3;
+    }
+  }
+
+  size_t toByte(size_t pCharIndex)
+  {
+    if (pCharIndex < charIndex) {
+      charIndex = 0;
+      byteOffset = 0;
+    }
+
+    while (charIndex < pCharIndex && byteOffset < source.size()) {
+      byteOffset++;
+      while (byteOffset < source.size() &&
+             (static_cast<unsigned char>(source[byteOffset]) & 0xC0) == 0x80) {
+        byteOffset++;
+      }
+      charIndex++;
+    }
+
+    return byteOffset;
+  }
+
+  // returns the slice of the input holding exactly pScalar, or an empty view
+  // when the scalar was unescaped or folded by the parser
+  std::string_view slice(const yaml_event_t& pEvent)
+  {
+    const char* scalar = (const char*)pEvent.data.scalar.value;
+    size_t length = pEvent.data.scalar.length;
+
+    size_t begin = toByte(pEvent.start_mark.index);
+    size_t end = toByte(pEvent.end_mark.index);
+    if (pEvent.data.scalar.style == YAML_SINGLE_QUOTED_SCALAR_STYLE ||
+        pEvent.data.scalar.style == YAML_DOUBLE_QUOTED_SCALAR_STYLE) {
+      begin++;
+      end--;
+    }
+
+    if (end < begin || end - begin != length || end > source.size() ||
+        std::memcmp(source.data() + begin, scalar, length) != 0) {
+      return std::string_view();
+    }
+
+    return source.substr(begin, length);
+  }
+
+private:
+  std::string_view source;
+  size_t charIndex = 0;
+  size_t byteOffset = 0;
+};
+
+class Parser
+{
+public:
+  Parser()
+  {
+    if (!yaml_parser_initialize(&parser)) {
+      yaml_parser_delete(&parser);
+      throw DocParserException("Could not initialize yaml parser");
+    }
+  }
+
+  Parser(const Parser&) = delete;
+  Parser& operator=(const Parser&) = delete;
+
+  ~Parser() { yaml_parser_delete(&parser); }
+
+  yaml_parser_t parser;
+};
+
+// the source of yaml_parser_set_input(), exceptions can't cross libyaml
+struct Input
+{
+  const std::function<size_t(char*, size_t)>& read;
+  std::exception_ptr error;
+
+  static int handler(void* pData,
+                     unsigned char* pBuffer,
+                     size_t pSize,
+                     size_t* pRead)
+  {
+    Input& input = *static_cast<Input*>(pData);
+    try {
+      *pRead = std::min(input.read(reinterpret_cast<char*>(pBuffer), pSize),
+                        pSize);
+      return 1;
+    } catch (...) {
+      input.error = std::current_exception();
+      return 0;
+    }
+  }
+};
+}
+
+EventReader::EventReader(DocVisitor& pVisitor)
+  : visitor(pVisitor)
+{
+}
+
+void EventReader::readString(std::string_view pSource)
+{
+  Parser parser;
+  yaml_parser_set_input_string(
+    &parser.parser, (unsigned const char*)pSource.data(), pSource.size());
+  read(parser.parser, pSource);
+}
+
+void EventReader::readFile(FILE* pFile)
+{
+  Parser parser;
+  yaml_parser_set_input_file(&parser.parser, pFile);
+  read(parser.parser, std::string_view());
+}
+
+void EventReader::readInput(const std::function<size_t(char*, size_t)>& pRead)
+{
+  Parser parser;
+  Input input{ pRead, nullptr };
+  yaml_parser_set_input(&parser.parser, &Input::handler, &input);
+  try {
+    read(parser.parser, std::string_view());
+  } catch (const DocParserException&) {
+    if (input.error) {
+      std::rethrow_exception(input.error);
+    }
+    throw;
+  }
+}
+
+void EventReader::read(yaml_parser_t& pParser, std::string_view pSource)
+{
+  using Clock = std::chrono::steady_clock;
+  SourceCursor cursor(pSource);
+  yaml_event_t event;
+  bool done = false;
+  Clock::time_point parsed;
+  while (!done) {
+    Clock::time_point asked;
+    if (stats) {
+      asked = Clock::now();
+    }
+    if (!yaml_parser_parse(&pParser, &event)) {
+      throw DocParserException(
+        "An error occured while parsing the document : " +
+        std::string(pParser.problem ? pParser.problem : "unknown error"));
+    }
+    if (stats) {
+      parsed = Clock::now();
+      stats->eventSeconds +=
+        std::chrono::duration<double>(parsed - asked).count();
+      stats->events++;
+    }
+
+    try {
+      switch (event.type) {
+        case YAML_DOCUMENT_START_EVENT:
+          frames.clear();
+          path.clear();
+          visitor.onDocumentStart();
+          break;
+
+        case YAML_DOCUMENT_END_EVENT:
+          visitor.onDocumentEnd();
+          break;
+
+        case YAML_MAPPING_START_EVENT:
+        case YAML_SEQUENCE_START_EVENT: {
+          if (atKey()) {
+            throw DocParserException(
+              "Complex mapping keys are not supported, at " + path);
+          }
+
+          bool mapping = event.type == YAML_MAPPING_START_EVENT;
+          enterNode();
+          yaml_char_t* anchor = mapping ? event.data.mapping_start.anchor
+                                        : event.data.sequence_start.anchor;
+          if (anchor) {
+            visitor.onAnchor(path, (const char*)anchor);
+          }
+          if (mapping) {
+            visitor.onMappingStart(path);
+          } else {
+            visitor.onSequenceStart(path);
+          }
+          frames.push_back({ mapping, mapping, 0, path.size() });
+        } break;
+
+        case YAML_MAPPING_END_EVENT:
+        case YAML_SEQUENCE_END_EVENT:
+          path.resize(frames.back().pathLength);
+          frames.pop_back();
+          if (event.type == YAML_MAPPING_END_EVENT) {
+            visitor.onMappingEnd(path);
+          } else {
+            visitor.onSequenceEnd(path);
+          }
+          leaveNode();
+          break;
+
+        case YAML_ALIAS_EVENT:
+          if (atKey()) {
+            throw DocParserException(
+              "Aliases as mapping keys are not supported, at " + path);
+          }
+          enterNode();
+          visitor.onAlias(path, (const char*)event.data.alias.anchor);
+          leaveNode();
+          break;
+
+        case YAML_SCALAR_EVENT: {
+          std::string_view value;
+          if (!pSource.empty()) {
+            value = cursor.slice(event);
+          }
+          if (value.data() == nullptr) {
+            value = std::string_view((const char*)event.data.scalar.value,
+                                     event.data.scalar.length);
+          }
+
+          if (atKey()) {
+            setKey(value);
+            visitor.onKey(
+              path,
+              value,
+              event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE);
+            break;
+          }
+
+          std::string_view tag;
+          if (event.data.scalar.tag) {
+            tag = (const char*)event.data.scalar.tag;
+          }
+
+          enterNode();
+          if (event.data.scalar.anchor) {
+            visitor.onAnchor(path, (const char*)event.data.scalar.anchor);
+          }
+          visitor.onScalar(path,
+                           value,
+                           tag,
+                           event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE);
+          leaveNode();
+        } break;
+
+        default:
+          break;
+      }
+    } catch (...) {
+      yaml_event_delete(&event);
+      throw;
+    }
+
+    done = event.type == YAML_STREAM_END_EVENT;
+    yaml_event_delete(&event);
+    if (stats) {
+      stats->buildSeconds +=
+        std::chrono::duration<double>(Clock::now() - parsed).count();
+    }
+  }
+}
+
+void EventReader::enterNode()
+{
+  if (frames.empty() || frames.back().mapping) {
+    return;
+  }
+
+  Frame& sequence = frames.back();
+  path.resize(sequence.pathLength);
+  if (!path.empty()) {
+    path += '.';
+  }
+
+  char digits[16];
+  auto [end, error] =
+    std::to_chars(digits, digits + sizeof(digits), sequence.itemCount++);
+  path.append(digits, end);
+}
+
+void EventReader::leaveNode()
+{
+  if (frames.empty()) {
+    return;
+  }
+
+  Frame& parent = frames.back();
+  path.resize(parent.pathLength);
+  parent.expectingKey = parent.mapping;
+}
+
+bool EventReader::atKey() const
+{
+  return !frames.empty() && frames.back().expectingKey;
+}
+
+void EventReader::setKey(std::string_view pKey)
+{
+  Frame& mapping = frames.back();
+  path.resize(mapping.pathLength);
+  if (!path.empty()) {
+    path += '.';
+  }
+  path += pKey;
+  mapping.expectingKey = false;
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DocVisitor.hpp"
+#include "ParseStats.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef struct yaml_parser_s yaml_parser_t;
+
+namespace YAML {
+
+// Drives a DocVisitor off libyaml events, keeping track of the dotted path of
+// the current node. Memory use grows with the nesting depth of the input, not
+// with its size.
+class EventReader
+{
+public:
+  EventReader(DocVisitor& pVisitor);
+
+  // scalars that appear verbatim in pSource are handed out as views into it
+  void readString(std::string_view pSource);
+
+  void readFile(FILE* pFile);
+
+  // pRead fills a buffer with the next bytes and returns how many, 0 at the
+  // end. What it throws is rethrown once libyaml gave up.
+  void readInput(const std::function<size_t(char*, size_t)>& pRead);
+
+  // counts events and times libyaml apart from the visitor into pStats
+  inline void setStats(ParseStats* pStats) { stats = pStats; }
+
+private:
+  struct Frame
+  {
+    bool mapping;
+    bool expectingKey;
+    uint32_t itemCount;
+    size_t pathLength;
+  };
+
+  void read(yaml_parser_t& pParser, std::string_view pSource);
+
+  void enterNode();
+  void leaveNode();
+
+  bool atKey() const;
+  void setKey(std::string_view pKey);
+
+private:
+  DocVisitor& visitor;
+  ParseStats* stats = nullptr;
+  std::vector<Frame> frames;
+  std::string path;
+};
+
+}
@@ -0,0 +1,28 @@
+#include "FrozenDoc.hpp"
+
+namespace YAML {
+
+FrozenDoc::FrozenDoc(Doc pDoc)
+  : doc(std::move(pDoc))
+{
+  // findChild() would build the missing indexes on the first lookup, which
+  // the const lookups don't do
+  Doc* root = &doc;
+  if (root->childCount >= ChildIndex::THRESHOLD &&
+      root->childIndex == DocArena::NO_NODE && !root->isAlias()) {
+    root->buildIndex();
+  }
+  if (root->arena == nullptr) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < root->arena->size(); i++) {
+    Doc* node = root->node(i);
+    if (node->childCount >= ChildIndex::THRESHOLD &&
+        node->childIndex == DocArena::NO_NODE && !node->isAlias()) {
+      node->buildIndex();
+    }
+  }
+}
+
+}
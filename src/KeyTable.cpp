@@ -0,0 +1,59 @@
+#include "KeyTable.hpp"
+
+namespace YAML {
+KeyTable::KeyTable(const allocator_type& pAllocator)
+  : keys(pAllocator)
+  , slots(pAllocator)
+  , items(pAllocator)
+{
+  // every document names its root, a literal outlives any table
+  keys.reserve(ChildIndex::THRESHOLD);
+  keys.push_back({ "", 0, static_cast<uint32_t>(hashKey("")) });
+  keys.push_back({ "root", 4, static_cast<uint32_t>(hashKey("root")) });
+}
+
+uint32_t KeyTable::findHashed(std::string_view pKey, uint64_t pHash) const
+{
+  auto matches = [&](uint32_t pId) { return get(pId) == pKey; };
+  if (isHashed()) {
+    return slots.find(pHash, matches);
+  }
+
+  uint32_t hash = static_cast<uint32_t>(pHash);
+  for (uint32_t id = ROOT; id < keys.size(); id++) {
+    if (keys[id].hash == hash && matches(id)) {
+      return id;
+    }
+  }
+  return NOT_FOUND;
+}
+
+uint32_t KeyTable::add(std::string_view pKey, uint64_t pHash, bool pHashed)
+{
+  uint32_t id = static_cast<uint32_t>(keys.size());
+  keys.push_back({ pKey.data(),
+                   static_cast<uint32_t>(pKey.size()),
+                   static_cast<uint32_t>(pHash) });
+
+  auto unique = [](uint32_t) { return false; };
+  if (isHashed() && id > ChildIndex::THRESHOLD) {
+    if (pHashed) {
+      slots.insert(pHash, id, unique);
+    }
+    return id;
+  }
+
+  // enough keys to hash them, found items stay out of the table
+  if (isHashed()) {
+    slots.reserve(static_cast<uint32_t>(keys.size()));
+    for (uint32_t key = ROOT; key < keys.size(); key++) {
+      uint32_t item;
+      if (isItem(get(key), item) && item < items.size()) {
+        continue;
+      }
+      slots.insert(keys[key].hash, key, unique);
+    }
+  }
+  return id;
+}
+}
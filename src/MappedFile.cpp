@@ -0,0 +1,91 @@
+#include "MappedFile.hpp"
+
+#include "exceptions/DocFileException.hpp"
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define YAML_DOC_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace YAML {
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& pPath,
+                                             bool pMap)
+{
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  size_t expected = 0;
+
+#ifdef YAML_DOC_HAS_MMAP
+  int descriptor = ::open(pPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0) {
+    throw DocFileException("Could not open file", pPath);
+  }
+
+  struct stat status;
+  if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) &&
+      status.st_size > 0) {
+    expected = (size_t)status.st_size;
+  }
+  if (pMap && expected > 0) {
+    void* mapping =
+      mmap(nullptr, expected, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      ::close(descriptor);
+      file->mapping = mapping;
+      file->mappingSize = expected;
+      file->bytes =
+        std::string_view(static_cast<const char*>(mapping), file->mappingSize);
+      file->adviseSequential(true);
+      return file;
+    }
+  }
+  ::close(descriptor);
+#endif
+
+  FILE* yamlFile = fopen(pPath.c_str(), "rb");
+  if (yamlFile == NULL) {
+    throw DocFileException("Could not open file", pPath);
+  }
+
+  // the size is only a hint, the file may change while it is read
+  file->content.reserve(expected);
+  char chunk[64 * 1024];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), yamlFile)) > 0) {
+    file->content.append(chunk, read);
+  }
+
+  bool failed = ferror(yamlFile);
+  fclose(yamlFile);
+  if (failed) {
+    throw DocFileException("Could not read file", pPath);
+  }
+
+  file->bytes = file->content;
+  return file;
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef YAML_DOC_HAS_MMAP
+  if (mapping) {
+    munmap(mapping, mappingSize);
+  }
+#endif
+}
+
+void MappedFile::adviseSequential(bool pSequential) const
+{
+#ifdef YAML_DOC_HAS_MMAP
+  if (mapping) {
+    madvise(mapping,
+            mappingSize,
+            pSequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+  }
+#endif
+}
+}
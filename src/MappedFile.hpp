@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace YAML {
+
+// Read-only view of a whole file. With pMap, regular files are memory mapped
+// where the platform allows it, anything else (pipes, procfs, other
+// platforms) is read into memory. A mapped file rewritten in place changes
+// the bytes under the view, truncating it while it is in use is undefined
+// (SIGBUS on most systems), as with any mapping.
+class MappedFile
+{
+public:
+  static std::shared_ptr<MappedFile> open(const std::string& pPath,
+                                          bool pMap);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  inline std::string_view getBytes() const { return bytes; }
+
+  inline bool isMapped() const { return mapping != nullptr; }
+
+  void adviseSequential(bool pSequential) const;
+
+private:
+  MappedFile() = default;
+
+private:
+  void* mapping = nullptr;
+  size_t mappingSize = 0;
+  std::string content;
+  std::string_view bytes;
+};
+
+}
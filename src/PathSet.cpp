@@ -0,0 +1,96 @@
+#include "PathSet.hpp"
+
+namespace YAML {
+PathSet::PathSet()
+{
+  entries.emplace_back();
+}
+
+PathSet::PathSet(std::initializer_list<std::string_view> pPaths)
+  : PathSet()
+{
+  for (std::string_view path : pPaths) {
+    add(path);
+  }
+}
+
+PathSet::PathSet(const std::vector<std::string>& pPaths)
+  : PathSet()
+{
+  for (const std::string& path : pPaths) {
+    add(path);
+  }
+}
+
+size_t PathSet::add(std::string_view pPath)
+{
+  uint32_t entry = 0;
+  size_t added = 0;
+  if (!pPath.empty()) {
+    size_t start = 0;
+    while (true) {
+      size_t end = pPath.find('.', start);
+      if (end == std::string_view::npos) {
+        end = pPath.size();
+      }
+
+      entry = child(entry, pPath.substr(start, end - start));
+      added++;
+
+      if (end == pPath.size()) {
+        break;
+      }
+      start = end + 1;
+    }
+  }
+
+  if (entries[entry].path == NONE) {
+    entries[entry].path = static_cast<uint32_t>(paths.size());
+    paths.push_back(entry);
+    segments += added;
+  }
+  return entries[entry].path;
+}
+
+std::string PathSet::getPath(size_t pIndex) const
+{
+  std::string path;
+  for (uint32_t entry = paths[pIndex]; entry != 0;
+       entry = entries[entry].parent) {
+    std::string_view segment = key(entries[entry]);
+    path.insert(0, segment);
+    if (entries[entry].parent != 0) {
+      path.insert(path.begin(), '.');
+    }
+  }
+  return path;
+}
+
+uint32_t PathSet::child(uint32_t pParent, std::string_view pKey)
+{
+  for (uint32_t entry = entries[pParent].firstChild; entry != NONE;
+       entry = entries[entry].nextSibling) {
+    if (key(entries[entry]) == pKey) {
+      return entry;
+    }
+  }
+
+  Entry added;
+  added.offset = static_cast<uint32_t>(text.size());
+  added.size = static_cast<uint32_t>(pKey.size());
+  added.hash = hashKey(pKey);
+  added.parent = pParent;
+  text.append(pKey);
+
+  uint32_t created = static_cast<uint32_t>(entries.size());
+  entries.push_back(added);
+  Entry& parent = entries[pParent];
+  if (parent.lastChild == NONE) {
+    parent.firstChild = created;
+  } else {
+    entries[parent.lastChild].nextSibling = created;
+  }
+  parent.lastChild = created;
+  return created;
+}
+}
@@ -0,0 +1,249 @@
+#include "Scalar.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace YAML {
+namespace {
+bool isDigit(char pChar)
+{
+  return pChar >= '0' && pChar <= '9';
+}
+
+// the core schema accepts exactly three spellings of each keyword
+bool isKeyword(std::string_view pText,
+               std::string_view pLower,
+               std::string_view pMixed,
+               std::string_view pUpper)
+{
+  return pText == pLower || pText == pMixed || pText == pUpper;
+}
+
+// matches [0-9]* and returns how many characters were consumed
+size_t skipDigits(std::string_view pText, size_t pFrom)
+{
+  size_t i = pFrom;
+  while (i < pText.size() && isDigit(pText[i])) {
+    i++;
+  }
+  return i - pFrom;
+}
+}
+
+bool Scalar::isNull(std::string_view pText)
+{
+  return pText.empty() || pText == "~" || isKeyword(pText, "null", "Null", "NULL");
+}
+
+bool Scalar::parseBool(std::string_view pText, bool& pOut)
+{
+  if (isKeyword(pText, "true", "True", "TRUE")) {
+    pOut = true;
+    return true;
+  }
+
+  if (isKeyword(pText, "false", "False", "FALSE")) {
+    pOut = false;
+    return true;
+  }
+
+  return false;
+}
+
+bool Scalar::parseInteger(std::string_view pText, int64_t& pOut)
+{
+  if (pText.empty()) {
+    return false;
+  }
+
+  char first = pText[0];
+  if (!isDigit(first) && first != '-' && first != '+') {
+    return false;
+  }
+
+  return parseNumber<int64_t>(pText, pOut);
+}
+
+bool Scalar::parseFloat(std::string_view pText, double& pOut)
+{
+  size_t i = 0;
+  bool negative = false;
+  if (!pText.empty() && (pText[0] == '-' || pText[0] == '+')) {
+    negative = pText[0] == '-';
+    i++;
+  }
+
+  std::string_view unsignedText = pText.substr(i);
+  if (isKeyword(unsignedText, ".inf", ".Inf", ".INF")) {
+    pOut = negative ? -INFINITY : INFINITY;
+    return true;
+  }
+
+  if (i == 0 && isKeyword(pText, ".nan", ".NaN", ".NAN")) {
+    pOut = NAN;
+    return true;
+  }
+
+  size_t integerStart = i;
+  size_t integerDigits = skipDigits(pText, i);
+  i += integerDigits;
+
+  size_t fractionStart = i + 1;
+  size_t fractionDigits = 0;
+  if (i < pText.size() && pText[i] == '.') {
+    i++;
+    fractionDigits = skipDigits(pText, i);
+    i += fractionDigits;
+  }
+
+  if (integerDigits == 0 && fractionDigits == 0) {
+    return false;
+  }
+
+  // decimal exponent of the first significant digit, clamped far beyond
+  // the range of a double
+  int64_t magnitude = -1;
+  size_t leading = integerStart;
+  while (leading < integerStart + integerDigits && pText[leading] == '0') {
+    leading++;
+  }
+  if (leading < integerStart + integerDigits) {
+    magnitude = int64_t(integerStart + integerDigits - leading) - 1;
+  } else {
+    for (size_t f = 0; f < fractionDigits && pText[fractionStart + f] == '0';
+         f++) {
+      magnitude--;
+    }
+  }
+
+  if (i < pText.size() && (pText[i] == 'e' || pText[i] == 'E')) {
+    i++;
+    bool negativeExponent = false;
+    if (i < pText.size() && (pText[i] == '-' || pText[i] == '+')) {
+      negativeExponent = pText[i] == '-';
+      i++;
+    }
+    size_t exponentDigits = skipDigits(pText, i);
+    if (exponentDigits == 0) {
+      return false;
+    }
+    int64_t exponent = 0;
+    for (size_t e = 0; e < exponentDigits; e++) {
+      exponent = std::min<int64_t>(exponent * 10 + (pText[i + e] - '0'),
+                                   1000000);
+    }
+    magnitude += negativeExponent ? -exponent : exponent;
+    i += exponentDigits;
+  }
+
+  if (i != pText.size()) {
+    return false;
+  }
+
+  // from_chars rejects a leading '+'
+  const char* begin = pText.data() + (pText[0] == '+' ? 1 : 0);
+  const char* end = pText.data() + pText.size();
+  auto [parsedEnd, error] = std::from_chars(begin, end, pOut);
+  if (error == std::errc::result_out_of_range) {
+    // keep YAML semantics instead of failing: huge values overflow to
+    // infinity, tiny ones underflow to zero
+    double limit = magnitude < 0 ? 0.0 : INFINITY;
+    pOut = negative ? -limit : limit;
+    return parsedEnd == end;
+  }
+
+  return error == std::errc() && parsedEnd == end;
+}
+
+Scalar::Kind Scalar::classify(std::string_view pText,
+                              int64_t& pInteger,
+                              double& pFloat)
+{
+  if (pText.empty()) {
+    return NULL_VALUE;
+  }
+
+  // only a handful of first characters can start anything but a string
+  switch (pText[0]) {
+    case '~':
+    case 'n':
+    case 'N':
+      return isNull(pText) ? NULL_VALUE : STRING;
+
+    case 't':
+    case 'T':
+    case 'f':
+    case 'F': {
+      bool value;
+      if (!parseBool(pText, value)) {
+        return STRING;
+      }
+      pInteger = value ? 1 : 0;
+      return BOOLEAN;
+    }
+
+    case '.':
+    case '-':
+    case '+':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      if (parseInteger(pText, pInteger)) {
+        return INTEGER;
+      }
+      // integers beyond int64_t stay text so unsigned conversions still work
+      if (parseFloat(pText, pFloat) &&
+          pText.find_first_of(".eE") != std::string_view::npos) {
+        return FLOAT;
+      }
+      return STRING;
+
+    default:
+      return STRING;
+  }
+}
+
+Scalar::Kind Scalar::classify(std::string_view pText,
+                              std::string_view pTag,
+                              int64_t& pInteger,
+                              double& pFloat)
+{
+  if (pTag.empty()) {
+    return classify(pText, pInteger, pFloat);
+  }
+
+  constexpr std::string_view prefix = "tag:yaml.org,2002:";
+  if (pTag.substr(0, prefix.size()) != prefix) {
+    return STRING;
+  }
+
+  std::string_view type = pTag.substr(prefix.size());
+  bool boolean;
+  if (type == "int" && parseInteger(pText, pInteger)) {
+    return INTEGER;
+  }
+  if (type == "float" && parseFloat(pText, pFloat)) {
+    return FLOAT;
+  }
+  if (type == "float" && parseInteger(pText, pInteger)) {
+    pFloat = static_cast<double>(pInteger);
+    return FLOAT;
+  }
+  if (type == "bool" && parseBool(pText, boolean)) {
+    pInteger = boolean ? 1 : 0;
+    return BOOLEAN;
+  }
+  if (type == "null" && isNull(pText)) {
+    return NULL_VALUE;
+  }
+
+  return STRING;
+}
+}
@@ -0,0 +1,77 @@
+#include "Selection.hpp"
+
+namespace YAML {
+Selection::Selection(std::initializer_list<std::string_view> pPrefixes)
+{
+  for (std::string_view prefix : pPrefixes) {
+    add(prefix);
+  }
+}
+
+Selection::Selection(const std::vector<std::string>& pPrefixes)
+{
+  for (const std::string& prefix : pPrefixes) {
+    add(prefix);
+  }
+}
+
+void Selection::add(std::string_view pPrefix)
+{
+  std::vector<std::string>& segments = prefixes.emplace_back();
+  if (pPrefix.empty()) {
+    return;
+  }
+
+  size_t start = 0;
+  while (true) {
+    size_t end = pPrefix.find('.', start);
+    if (end == std::string_view::npos) {
+      end = pPrefix.size();
+    }
+
+    segments.emplace_back(pPrefix.substr(start, end - start));
+
+    if (end == pPrefix.size()) {
+      break;
+    }
+    start = end + 1;
+  }
+}
+
+Selection::Match Selection::match(std::string_view pPath) const
+{
+  Match best = OUTSIDE;
+  for (const std::vector<std::string>& segments : prefixes) {
+    size_t start = 0;
+    size_t matched = 0;
+    bool mismatch = false;
+    while (matched < segments.size() && start <= pPath.size() &&
+           !pPath.empty()) {
+      size_t end = pPath.find('.', start);
+      if (end == std::string_view::npos) {
+        end = pPath.size();
+      }
+
+      const std::string& segment = segments[matched];
+      if (segment != "*" && segment != pPath.substr(start, end - start)) {
+        mismatch = true;
+        break;
+      }
+
+      matched++;
+      start = end + 1;
+    }
+
+    if (mismatch) {
+      continue;
+    }
+    if (matched == segments.size()) {
+      return INSIDE;
+    }
+    best = ANCESTOR;
+  }
+
+  return best;
+}
+
+}
@@ -0,0 +1,365 @@
+#include "Snapshot.hpp"
+#include "MappedFile.hpp"
+
+#include "exceptions/DocException.hpp"
+#include "exceptions/DocFileException.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace YAML {
+namespace {
+constexpr char MAGIC[8] = { 'Y', 'A', 'M', 'L', 'D', 'O', 'C', '\0' };
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  // node records, the root's first, followed by the string pool
+  uint64_t recordCount;
+  uint64_t poolSize;
+  uint64_t sourcePath;
+  uint64_t sourcePathLength;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+};
+
+struct Record
+{
+  uint64_t name;
+  uint64_t value;
+  uint32_t nameLength;
+  uint32_t valueLength;
+  uint32_t parent;
+  uint32_t firstChild;
+  uint32_t lastChild;
+  uint32_t nextSibling;
+  uint32_t childCount;
+  uint32_t alias;
+  uint8_t type;
+  uint8_t kind;
+  uint8_t padding[6];
+  uint64_t number;
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(Record) == 64);
+
+// strings of the snapshot, keys repeated across a document are stored once
+class Pool
+{
+public:
+  // offset 0 is the empty string
+  Pool()
+    : bytes(1, '\0')
+  {
+  }
+
+  uint64_t add(std::string_view pString)
+  {
+    if (pString.empty()) {
+      return 0;
+    }
+
+    auto [found, added] = offsets.try_emplace(pString, bytes.size());
+    if (added) {
+      bytes += pString;
+      bytes += '\0';
+    }
+    return found->second;
+  }
+
+  std::string bytes;
+
+private:
+  std::unordered_map<std::string_view, uint64_t> offsets;
+};
+
+void writeFile(const std::string& pPath,
+               const Header& pHeader,
+               const std::vector<Record>& pRecords,
+               const std::string& pPool)
+{
+  FILE* file = fopen(pPath.c_str(), "wb");
+  if (file == NULL) {
+    throw DocFileException("Could not create file", pPath);
+  }
+
+  bool written =
+    fwrite(&pHeader, sizeof(Header), 1, file) == 1 &&
+    fwrite(pRecords.data(), sizeof(Record), pRecords.size(), file) ==
+      pRecords.size() &&
+    fwrite(pPool.data(), 1, pPool.size(), file) == pPool.size();
+  written = fclose(file) == 0 && written;
+
+  if (!written) {
+    std::remove(pPath.c_str());
+    throw DocFileException("Could not write file", pPath);
+  }
+}
+}
+
+void Doc::saveSnapshot(const std::string& pPath) const
+{
+  if (!ownsArena()) {
+    Snapshot::write(Doc(*this), pPath, Snapshot::Source());
+    return;
+  }
+
+  Snapshot::write(*this, pPath, Snapshot::Source());
+}
+
+Doc Doc::loadSnapshot(const std::string& pPath)
+{
+  return Snapshot::read(pPath);
+}
+
+void Snapshot::write(const Doc& pRoot,
+                     const std::string& pPath,
+                     const Source& pSource)
+{
+  uint32_t count = pRoot.arena ? pRoot.arena->size() : 0;
+  std::vector<Record> records;
+  records.reserve(size_t(count) + 1);
+
+  // nodes keep their arena index, aliases to detached nodes stay valid
+  Pool pool;
+  auto addRecord = [&](const Doc& pNode) {
+    Record record = {};
+    std::string_view name = pNode.getNameView();
+    record.name = pool.add(name);
+    record.nameLength = static_cast<uint32_t>(name.size());
+    record.value = pool.add(pNode.value);
+    record.valueLength = static_cast<uint32_t>(pNode.value.size());
+    record.parent = pNode.parent;
+    record.firstChild = pNode.firstChild;
+    record.lastChild = pNode.lastChild;
+    record.nextSibling = pNode.nextSibling;
+    record.childCount = pNode.childCount;
+    record.alias = pNode.alias;
+    record.type = static_cast<uint8_t>(pNode.type);
+    record.kind = static_cast<uint8_t>(pNode.kind);
+    std::memcpy(&record.number, &pNode.number, sizeof(record.number));
+    records.push_back(record);
+  };
+
+  addRecord(pRoot);
+  for (uint32_t i = 0; i < count; i++) {
+    addRecord(*pRoot.node(i));
+  }
+
+  Header header = {};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.recordCount = records.size();
+  header.sourcePath = pool.add(pSource.path);
+  header.sourcePathLength = pSource.path.size();
+  header.sourceSize = pSource.size;
+  header.sourceTime = pSource.time;
+  header.poolSize = pool.bytes.size();
+
+  writeFile(pPath, header, records, pool.bytes);
+}
+
+Doc Snapshot::read(const std::string& pPath,
+                   const Source* pExpected,
+                   std::pmr::memory_resource* pMemory)
+{
+  // snapshots are only ever replaced by a rename, see parseCached()
+  std::shared_ptr<MappedFile> file = MappedFile::open(pPath, true);
+  std::string_view bytes = file->getBytes();
+  auto invalid = [&]() { return DocFileException("Invalid snapshot", pPath); };
+
+  Header header;
+  if (bytes.size() < sizeof(Header)) {
+    throw invalid();
+  }
+  std::memcpy(&header, bytes.data(), sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+    throw invalid();
+  }
+
+  size_t available = (bytes.size() - sizeof(Header)) / sizeof(Record);
+  if (header.recordCount == 0 || header.recordCount > available ||
+      header.recordCount - 1 >= DocArena::ROOT_NODE) {
+    throw invalid();
+  }
+
+  std::string_view pool =
+    bytes.substr(sizeof(Header) + header.recordCount * sizeof(Record));
+  if (pool.size() != header.poolSize || pool.empty() || pool[0] != '\0') {
+    throw invalid();
+  }
+
+  auto text = [&](uint64_t pOffset, uint64_t pLength) {
+    if (pOffset >= pool.size() || pLength >= pool.size() - pOffset ||
+        pool[pOffset + pLength] != '\0') {
+      throw invalid();
+    }
+    return pLength == 0 ? std::string_view() : pool.substr(pOffset, pLength);
+  };
+
+  if (pExpected &&
+      (text(header.sourcePath, header.sourcePathLength) != pExpected->path ||
+       header.sourceSize != pExpected->size ||
+       header.sourceTime != pExpected->time)) {
+    throw DocFileException("Snapshot out of date", pPath);
+  }
+
+  Doc doc;
+  DocArena* arena = doc.ensureArena(pMemory);
+  arena->retain(file, bytes);
+
+  // links to children and siblings only point forward, to parents and
+  // aliased nodes only backward, so a damaged file can't make a walk loop
+  uint32_t count = static_cast<uint32_t>(header.recordCount - 1);
+  const char* next = bytes.data() + sizeof(Header);
+  for (uint32_t i = 0; i <= count; i++, next += sizeof(Record)) {
+    Record record;
+    std::memcpy(&record, next, sizeof(Record));
+
+    bool root = i == 0;
+    uint32_t self = root ? DocArena::ROOT_NODE : i - 1;
+    auto forward = [&](uint32_t pLink) {
+      return pLink == DocArena::NO_NODE ||
+             (pLink < count && (root || pLink > self));
+    };
+    auto backward = [&](uint32_t pLink) {
+      return pLink == DocArena::NO_NODE || (!root && pLink < self);
+    };
+
+    bool linked =
+      forward(record.firstChild) && forward(record.lastChild) &&
+      forward(record.nextSibling) && backward(record.alias) &&
+      (root ? record.parent == DocArena::NO_NODE &&
+                record.nextSibling == DocArena::NO_NODE
+            : backward(record.parent) || record.parent == DocArena::ROOT_NODE);
+    if (!linked || record.type > Doc::SEQUENCE ||
+        record.kind > Scalar::FLOAT) {
+      throw invalid();
+    }
+
+    Doc* node = root ? &doc : doc.node(arena->allocate());
+    node->type = static_cast<Doc::Type>(record.type);
+    node->kind = static_cast<Scalar::Kind>(record.kind);
+    std::memcpy(&node->number, &record.number, sizeof(record.number));
+    node->key = arena->internKey(text(record.name, record.nameLength));
+    node->value = text(record.value, record.valueLength);
+    // every pooled string is NUL terminated
+    node->flags = Doc::TERMINATED_VALUE;
+    node->arena = arena;
+    node->index = self;
+    node->parent = record.parent;
+    node->firstChild = record.firstChild;
+    node->lastChild = record.lastChild;
+    node->nextSibling = record.nextSibling;
+    node->childCount = record.childCount;
+    node->alias = record.alias;
+
+    if (node->isAlias() && doc.node(node->alias)->isAlias()) {
+      throw invalid();
+    }
+  }
+
+  // each chain of children links back to the node it hangs from and ends at
+  // its last child after childCount nodes. Wide mappings are indexed, as
+  // after a parse.
+  for (uint32_t i = 0; i <= count; i++) {
+    Doc* node = i == 0 ? &doc : doc.node(i - 1);
+    uint32_t children = 0;
+    uint32_t last = DocArena::NO_NODE;
+    for (uint32_t child = node->firstChild; child != DocArena::NO_NODE;
+         child = doc.node(child)->nextSibling) {
+      if (doc.node(child)->parent != node->index) {
+        throw invalid();
+      }
+      last = child;
+      children++;
+    }
+    if (children != node->childCount || last != node->lastChild) {
+      throw invalid();
+    }
+
+    if (!node->isAlias() && node->childCount >= ChildIndex::THRESHOLD) {
+      node->buildIndex();
+    }
+  }
+
+  file->adviseSequential(false);
+  return doc;
+}
+
+Doc Snapshot::parseCached(const std::string& pPath,
+                          const ParseOptions& pOptions)
+{
+  namespace fs = std::filesystem;
+
+  ParseOptions options = pOptions;
+  options.snapshotCache.clear();
+
+  std::error_code error;
+  Source source;
+  source.path = fs::absolute(pPath, error).string();
+  if (!error) {
+    source.size = fs::file_size(pPath, error);
+  }
+  if (!error) {
+    source.time = fs::last_write_time(pPath, error).time_since_epoch().count();
+  }
+  if (error) {
+    return Doc::parseFile(pPath, options);
+  }
+
+  char name[32];
+  std::snprintf(name,
+                sizeof(name),
+                "%016llx.ydoc",
+                static_cast<unsigned long long>(hashKey(source.path)));
+  std::string cached = (fs::path(pOptions.snapshotCache) / name).string();
+
+  // missing, out of date or damaged snapshots are made again
+  try {
+    auto start = std::chrono::steady_clock::now();
+    Doc doc = read(cached, &source, pOptions.memory);
+    if (ParseStats* stats = pOptions.stats) {
+      *stats = ParseStats();
+      stats->bytes = source.size;
+      stats->fromSnapshot = true;
+      doc.collectStats(*stats);
+      stats->totalSeconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    }
+    return doc;
+  } catch (const DocException&) {
+  }
+
+  Doc doc = Doc::parseFile(pPath, options);
+
+  // written aside then renamed, so that processes sharing the cache never
+  // map half a snapshot. Failing to write it only costs the next parse.
+  fs::create_directories(pOptions.snapshotCache, error);
+  std::string written =
+    cached + "." + std::to_string(std::random_device()()) + ".tmp";
+  try {
+    write(doc, written, source);
+    fs::rename(written, cached, error);
+    if (error) {
+      fs::remove(written, error);
+    }
+  } catch (const DocFileException&) {
+  }
+
+  return doc;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Doc.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace YAML {
+
+// Binary image of a document arena: a header, one fixed size record per node
+// holding its links as node indexes, and a pool of NUL terminated strings the
+// records point into by offset. Loading maps the file and fills the arena from
+// the records in one pass, names and values stay views into the mapping.
+//
+// Records are written in the byte order of the machine, a snapshot made on a
+// machine of the other order is rejected like any other invalid file.
+class Snapshot
+{
+public:
+  // the file a snapshot was made from, checked before the cache reuses it
+  struct Source
+  {
+    std::string path;
+    uint64_t size = 0;
+    int64_t time = 0;
+  };
+
+  static void write(const Doc& pRoot,
+                    const std::string& pPath,
+                    const Source& pSource);
+
+  // throws DocFileException when the file isn't a valid snapshot, or was
+  // made from another source than pExpected when given
+  static Doc read(const std::string& pPath,
+                  const Source* pExpected = nullptr,
+                  std::pmr::memory_resource* pMemory = nullptr);
+
+  // parseFile() through a snapshot kept in pOptions.snapshotCache
+  static Doc parseCached(const std::string& pPath,
+                         const ParseOptions& pOptions);
+};
+
+}
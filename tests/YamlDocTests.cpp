@@ -1,20 +1,72 @@
+#include "yaml-doc/ColumnSet.hpp"
 #include "yaml-doc/Doc.hpp"
+#include "yaml-doc/DocHolder.hpp"
+#include "yaml-doc/DocWriter.hpp"
+#include "yaml-doc/PathBinding.hpp"
 #include "yaml-doc/exceptions/DocException.hpp"
+#include "yaml-doc/exceptions/DocFileException.hpp"
+#include "yaml-doc/exceptions/DocNodeException.hpp"
+#include "yaml-doc/exceptions/DocParserException.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory_resource>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 struct InventoryItem
+{
+  std::string item = "unknown";
+  int quantity = 1;
+  int damage = 0;
+};
+
+YAML_DOC_FIELDS(InventoryItem, item, quantity, damage)
+
+struct Character
+{
+  std::string name;
+  int level = 1;
+  double speed = 1.0;
+  bool hero = false;
+  std::vector<std::string> tags;
+  std::vector<InventoryItem> inventory;
+};
+
+YAML_DOC_FIELDS(Character, name, level, speed, hero, tags, inventory)
+
+// decoded by specializing getValue<T>() rather than with YAML_DOC_FIELDS
+struct Pickup
 {
   std::string item;
   int quantity;
+};
+
+template<>
+inline Pickup YAML::Doc::getValue<Pickup>()
+{
+  return { .item = getValue("item", "unknown"),
+           .quantity = getValue<int>("quantity", 1) };
+}
+
+struct Weapon
+{
+  std::string item;
   int damage;
 };
 
 template<>
-inline InventoryItem YAML::Doc::getValue<InventoryItem>()
+inline Weapon YAML::Doc::getValue<Weapon>() const
 {
   return { .item = getValue("item", "unknown"),
-           .quantity = getValue<int>("quantity", 1),
            .damage = getValue<int>("damage", 0) };
 }
 
@@ -50,6 +102,17 @@ TEST_SUITE("Testing YamlDoc")
       InventoryItem item = doc.getValue<InventoryItem>("inventory.2");
       CHECK(item.item == "dagger");
 
+      Pickup pickup = doc.getValue<Pickup>("inventory.0");
+      CHECK(pickup.item == "banana");
+      CHECK(pickup.quantity == 2);
+      CHECK(doc.getNode("inventory.1")->getValue<Pickup>().quantity == 1);
+
+      const YAML::Doc& constDoc = doc;
+      Weapon weapon = constDoc.getValue<Weapon>("inventory.2");
+      CHECK(weapon.item == "dagger");
+      CHECK(weapon.damage == 5);
+      CHECK(doc.getValue<Weapon>("inventory.1").damage == 0);
+
       float notFoundValue = 12.5f;
       doc.tryGetValue("non.existant.path", &notFoundValue);
       CHECK(notFoundValue == 12.5f);
@@ -68,4 +131,1350 @@ TEST_SUITE("Testing YamlDoc")
       FAIL(std::string(e.what()));
     }
   }
+
+  TEST_CASE("Node links survive growth, copies and moves")
+  {
+    YAML::Doc doc;
+    YAML::Doc* list = doc.addSequenceItem();
+    for (int i = 0; i < 1000; i++) {
+      YAML::Doc* item = list->addSequenceItem();
+      item->addSequenceItem();
+    }
+
+    YAML::Doc* first = doc.getNode("0.0.0");
+    CHECK(first->getParent()->getParent() == list);
+    CHECK(list->getParent() == &doc);
+    CHECK(list->getChildCount() == 1000);
+
+    YAML::Doc moved = std::move(doc);
+    CHECK(moved.getNode("0")->getParent() == &moved);
+    CHECK(moved.getNode("0.999") != nullptr);
+
+    YAML::Doc copy = *moved.getNode("0");
+    CHECK(copy.getParent() == nullptr);
+    CHECK(copy.getChildCount() == 1000);
+    CHECK(copy.getNode("500")->getParent() == &copy);
+    CHECK(copy.getNode("500") != moved.getNode("0.500"));
+  }
+
+  TEST_CASE("Plain scalars are views into the retained input")
+  {
+    std::string input = "cl\u00e9: v\u00e4lue\n"
+                        "plain: some plain text\n"
+                        "quoted: 'it''s'\n"
+                        "escaped: \"tab\\there\"\n"
+                        "simple: \"no escapes\"\n"
+                        "block: |\n  first\n  second\n";
+    const char* begin = input.data();
+    const char* end = begin + input.size();
+
+    YAML::Doc doc = YAML::Doc::parseString(std::move(input));
+
+    auto inInput = [&](std::string_view pView) {
+      return pView.data() >= begin && pView.data() + pView.size() <= end;
+    };
+
+    std::string_view plain = doc.getNode("plain")->getValueView();
+    CHECK(plain == "some plain text");
+    CHECK(inInput(plain));
+    CHECK(inInput(doc.getNode("plain")->getNameView()));
+    CHECK(doc.getValue("cl\u00e9") == "v\u00e4lue");
+
+    CHECK(doc.getNode("simple")->getValueView() == "no escapes");
+    CHECK(inInput(doc.getNode("simple")->getValueView()));
+
+    CHECK(doc.getNode("quoted")->getValueView() == "it's");
+    CHECK_FALSE(inInput(doc.getNode("quoted")->getValueView()));
+    CHECK(doc.getNode("escaped")->getValueView() == "tab\there");
+    CHECK(doc.getNode("block")->getValueView() == "first\nsecond\n");
+
+    CHECK(std::string(doc.getNode("plain")->getValueOr("")) ==
+          "some plain text");
+  }
+
+  TEST_CASE("Parsing a missing file throws")
+  {
+    CHECK_THROWS_AS(YAML::Doc::parseFile("tests_files/missing.yaml"),
+                    YAML::DocException);
+  }
+
+  TEST_CASE("Lookups in wide mappings")
+  {
+    std::string input = "flags:\n";
+    for (int i = 0; i < 200; i++) {
+      input += "  flag" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+    }
+    input += "  flag7: duplicate\n";
+
+    YAML::Doc doc = YAML::Doc::parseString(input);
+    YAML::Doc* flags = doc.getNode("flags");
+    CHECK(flags->getChildCount() == 201);
+
+    for (int i = 0; i < 200; i++) {
+      CHECK(flags->getValue<int>("flag" + std::to_string(i)) == i);
+    }
+    CHECK(flags->getValue("flag7") == "7");
+
+    YAML::Doc* missing;
+    CHECK_FALSE(flags->tryGetNode("flag200", missing));
+
+    YAML::Doc* list = doc.addSequenceItem();
+    for (int i = 0; i < 100; i++) {
+      list->addSequenceItem();
+    }
+    CHECK(doc.getNode("1.99") != nullptr);
+    list->addSequenceItem();
+    CHECK(doc.getNode("1.100")->getParent() == list);
+  }
+
+  TEST_CASE("Lookups through precompiled paths")
+  {
+    using namespace YAML::literals;
+
+    static constexpr YAML::Path damagePath("inventory.2.damage");
+    static_assert(damagePath.size() == 3);
+    static_assert(damagePath[1].key == "2");
+    static_assert(damagePath[2].hash == YAML::hashKey("damage"));
+
+    YAML::Doc doc = YAML::Doc::parseFile("tests_files/basic_parsing.yaml");
+
+    CHECK(doc.getValue<int>(damagePath) == 5);
+    CHECK(doc.getValue("name"_path) == "Average Person");
+    CHECK(doc.getValue<int>("inventory.0.quantity"_path, 0) == 2);
+    CHECK(doc.getValue("inventory.1.damage"_path, "none") == "none");
+    CHECK(doc.getNode(YAML::Path()) == &doc);
+
+    std::string runtime = "inventory.1.item";
+    YAML::Path glassesPath(runtime);
+    std::string glasses;
+    CHECK(doc.tryGetValue(glassesPath, &glasses));
+    CHECK(glasses == "glasses");
+
+    YAML::Doc* missing;
+    CHECK_FALSE(doc.tryGetNode("inventory.3"_path, missing));
+    CHECK_THROWS_AS(doc.getNode("inventory.3"_path), YAML::DocNodeException);
+  }
+
+  TEST_CASE("Core schema scalar conversions")
+  {
+    YAML::Doc doc = YAML::Doc::parseString("decimal: -42\n"
+                                           "hex: 0x1F\n"
+                                           "octal: 0o17\n"
+                                           "real: 6.25e2\n"
+                                           "infinity: -.inf\n"
+                                           "huge: 1e400\n"
+                                           "tiny: 1e-400\n"
+                                           "negativeTiny: -1e-400\n"
+                                           "smallMantissa: 0.0001e-320\n"
+                                           "nan: .NaN\n"
+                                           "yes: True\n"
+                                           "nothing: ~\n"
+                                           "quoted: \"12\"\n"
+                                           "tagged: !!str 12\n"
+                                           "big: 18446744073709551615\n"
+                                           "word: 12abc\n");
+
+    CHECK(doc.getNode("decimal")->getScalarKind() == YAML::Scalar::INTEGER);
+    CHECK(doc.getValue<int>("decimal") == -42);
+    CHECK(doc.getValue<double>("decimal") == -42.0);
+    CHECK(doc.getValue<int>("hex") == 31);
+    CHECK(doc.getValue<int>("octal") == 15);
+
+    CHECK(doc.getNode("real")->getScalarKind() == YAML::Scalar::FLOAT);
+    CHECK(doc.getValue<double>("real") == 625.0);
+    CHECK_THROWS_AS(doc.getValue<int>("real"), YAML::DocConversionException);
+    CHECK(doc.getValue<double>("infinity") ==
+          -std::numeric_limits<double>::infinity());
+    // out of range values overflow to infinity and underflow to zero
+    CHECK(doc.getValue<double>("huge") ==
+          std::numeric_limits<double>::infinity());
+    CHECK(doc.getValue<double>("tiny") == 0.0);
+    CHECK_FALSE(std::signbit(doc.getValue<double>("tiny")));
+    CHECK(doc.getValue<double>("negativeTiny") == 0.0);
+    CHECK(std::signbit(doc.getValue<double>("negativeTiny")));
+    CHECK(doc.getValue<double>("smallMantissa") == 0.0);
+    CHECK(std::isnan(doc.getValue<double>("nan")));
+
+    CHECK(doc.getNode("yes")->getScalarKind() == YAML::Scalar::BOOLEAN);
+    CHECK(doc.getValue<bool>("yes"));
+    CHECK(doc.getNode("nothing")->getScalarKind() == YAML::Scalar::NULL_VALUE);
+
+    CHECK(doc.getNode("quoted")->getScalarKind() == YAML::Scalar::STRING);
+    CHECK(doc.getValue<int>("quoted") == 12);
+    CHECK(doc.getNode("tagged")->getScalarKind() == YAML::Scalar::STRING);
+
+    CHECK(doc.getValue<uint64_t>("big") == 18446744073709551615ull);
+    CHECK_THROWS_AS(doc.getValue<int>("big"), YAML::DocConversionException);
+    CHECK_THROWS_AS(doc.getValue<uint8_t>("decimal"),
+                    YAML::DocConversionException);
+
+    CHECK(doc.getValue<int>("word", 7) == 7);
+    CHECK(doc.getValue<int>("missing", 3) == 3);
+  }
+
+  TEST_CASE("Iterating children and subtrees")
+  {
+    YAML::Doc doc = YAML::Doc::parseFile("tests_files/basic_parsing.yaml");
+
+    YAML::Doc* inventory = doc.getNode("inventory");
+    std::vector<std::string> items;
+    for (YAML::Doc& item : inventory->children()) {
+      items.push_back(item.getValue("item"));
+    }
+    CHECK(items == std::vector<std::string>{ "banana", "glasses", "dagger" });
+    CHECK(inventory->children().size() == 3);
+    CHECK(&*inventory->children().begin() == doc.getNode("inventory.0"));
+
+    const YAML::Doc& constInventory = *inventory;
+    size_t count = 0;
+    for (const YAML::Doc& item : constInventory.children()) {
+      count += item.getChildCount();
+    }
+    CHECK(count == 5);
+
+    std::vector<std::string> preorder;
+    for (auto it = inventory->depthFirst().begin();
+         it != inventory->depthFirst().end();
+         ++it) {
+      preorder.push_back(std::to_string(it.depth()) + it->getName());
+    }
+    CHECK(preorder == std::vector<std::string>{ "10",
+                                                "2item",
+                                                "2quantity",
+                                                "11",
+                                                "2item",
+                                                "12",
+                                                "2item",
+                                                "2damage" });
+
+    std::vector<std::string> levels;
+    for (YAML::Doc& node : inventory->breadthFirst()) {
+      levels.push_back(node.getName());
+    }
+    CHECK(levels == std::vector<std::string>{
+                      "0", "1", "2", "item", "quantity", "item", "item", "damage" });
+
+    size_t nodes = 0;
+    for ([[maybe_unused]] YAML::Doc& node : doc.depthFirst()) {
+      nodes++;
+    }
+    CHECK(nodes == 14);
+  }
+
+  class EventRecorder : public YAML::DocVisitor
+  {
+  public:
+    void onMappingStart(std::string_view pPath) override
+    {
+      events.push_back("{ " + std::string(pPath));
+    }
+
+    void onMappingEnd(std::string_view pPath) override
+    {
+      events.push_back("} " + std::string(pPath));
+    }
+
+    void onSequenceStart(std::string_view pPath) override
+    {
+      events.push_back("[ " + std::string(pPath));
+    }
+
+    void onSequenceEnd(std::string_view pPath) override
+    {
+      events.push_back("] " + std::string(pPath));
+    }
+
+    void onKey(std::string_view pPath,
+               std::string_view /*pKey*/,
+               bool /*pPlain*/) override
+    {
+      events.push_back("key " + std::string(pPath));
+    }
+
+    void onScalar(std::string_view pPath,
+                  std::string_view pValue,
+                  std::string_view /*pTag*/,
+                  bool /*pPlain*/) override
+    {
+      events.push_back(std::string(pPath) + "=" + std::string(pValue));
+    }
+
+    std::vector<std::string> events;
+  };
+
+  TEST_CASE("Visiting a document without building it")
+  {
+    EventRecorder recorder;
+    YAML::Doc::parseString("a: [1, {b: 'x'}]\nc: [[2]]\n", recorder);
+    CHECK(recorder.events == std::vector<std::string>{ "{ ",
+                                                       "key a",
+                                                       "[ a",
+                                                       "a.0=1",
+                                                       "{ a.1",
+                                                       "key a.1.b",
+                                                       "a.1.b=x",
+                                                       "} a.1",
+                                                       "] a",
+                                                       "key c",
+                                                       "[ c",
+                                                       "[ c.0",
+                                                       "c.0.0=2",
+                                                       "] c.0",
+                                                       "] c",
+                                                       "} " });
+
+    struct QuantitySum : YAML::DocVisitor
+    {
+      void onScalar(std::string_view pPath,
+                    std::string_view pValue,
+                    std::string_view /*pTag*/,
+                    bool /*pPlain*/) override
+      {
+        int64_t quantity;
+        if (pPath.starts_with("inventory.") && pPath.ends_with(".quantity") &&
+            YAML::Scalar::parseInteger(pValue, quantity)) {
+          total += quantity;
+        }
+      }
+
+      int64_t total = 0;
+    } sum;
+    YAML::Doc::parseFile("tests_files/basic_parsing.yaml", sum);
+    CHECK(sum.total == 2);
+
+    CHECK_THROWS_AS(YAML::Doc::parseFile("tests_files/missing.yaml", sum),
+                    YAML::DocFileException);
+    CHECK_THROWS_AS(YAML::Doc::parseString("a: [1\n", recorder),
+                    YAML::DocParserException);
+  }
+
+  TEST_CASE("Building only selected subtrees")
+  {
+    YAML::Doc doc = YAML::Doc::parseFile("tests_files/basic_parsing.yaml",
+                                         { "name", "inventory.*.item" });
+    YAML::Doc* missing;
+    CHECK(doc.getChildCount() == 2);
+    CHECK(doc.getValue("name") == "Average Person");
+    CHECK_FALSE(doc.tryGetNode("age", missing));
+    CHECK(doc.getNode("inventory")->getChildCount() == 3);
+    CHECK(doc.getValue("inventory.2.item") == "dagger");
+    CHECK_FALSE(doc.tryGetNode("inventory.0.quantity", missing));
+    CHECK_FALSE(doc.tryGetNode("inventory.2.damage", missing));
+
+    // skipped items keep the index they have in the input
+    YAML::Doc sparse = YAML::Doc::parseString("[a, b, c, d]", { "2", "3" });
+    CHECK(sparse.getChildCount() == 2);
+    CHECK(sparse.getValue("3") == "d");
+
+    // nodes on the way to a selection are built even when nothing below them
+    // matches
+    YAML::Doc items = YAML::Doc::parseString(
+      "list:\n  - {a: 1}\n  - {b: 2}\n  - {a: 3}\nother: [1, 2]\n",
+      { "list.*.a" });
+    CHECK(items.getNode("list")->getChildCount() == 3);
+    CHECK(items.getValue<int>("list.2.a") == 3);
+    CHECK(items.getNode("list.1")->getChildCount() == 0);
+    CHECK_FALSE(items.tryGetNode("other", missing));
+
+    YAML::Doc whole = YAML::Doc::parseString("a: {b: [1, 2]}\nc: 3\n", { "a" });
+    CHECK(whole.getValue<int>("a.b.1") == 2);
+    CHECK_FALSE(whole.tryGetNode("c", missing));
+
+    // unselected parts are still checked
+    CHECK_THROWS_AS(
+      YAML::Doc::parseString("a: 1\nb: [1\n", { "a" }),
+      YAML::DocParserException);
+  }
+
+  void checkSameTree(YAML::Doc& pFast, YAML::Doc& pSlow)
+  {
+    CHECK(pFast.getNameView() == pSlow.getNameView());
+    CHECK(pFast.getType() == pSlow.getType());
+    CHECK(pFast.getValueView() == pSlow.getValueView());
+    CHECK(pFast.getScalarKind() == pSlow.getScalarKind());
+    REQUIRE(pFast.getChildCount() == pSlow.getChildCount());
+
+    YAML::Doc* slowChild = pSlow.getFirstChild();
+    for (YAML::Doc& fastChild : pFast.children()) {
+      checkSameTree(fastChild, *slowChild);
+      slowChild = slowChild->getNextSibling();
+    }
+  }
+
+  TEST_CASE("Block scanner builds the same trees as libyaml")
+  {
+    YAML::ParseOptions libyaml;
+    libyaml.fastScan = false;
+
+    const char* inputs[] = {
+      "",
+      "# only a comment\n\n",
+      "a: 1\nb: text with spaces   \nc:\nd: 'quoted # not a comment'\n",
+      "a: \"double\"  # comment\nb: ''\nc: \"\"\n"
+      "d: -10\ne: 0x1F # hex\nf: .inf\n",
+      "url: http://example.com/a#b\nratio: 1:2\nlist: a,b[c]{d}\n",
+      "a:\n  b:\n    c: 1\n  d: 2\ne: 3\n",
+      "a:\n- 1\n- 2\nb:\n  - x\n  -\n  - y\n",
+      "- item: banana\n  quantity: 2\n- item: glasses\n"
+      "-   spaced: 1\n    more: 2\n",
+      "-\n  - 1\n  - 2\n-\n  a: 1\n- # empty\n- last\n",
+      "  indented: 1\n  root: 2\n",
+      "key:    \n\n   # comment\nnext: value\n",
+      "unicode: caf\xC3\xA9 \xE2\x82\xAC\nemoji: \xF0\x9F\x98\x80\n",
+      // constructs handed over to libyaml
+      "a: [1, 2]\nb: {c: d}\n",
+      "base: &base\n  a: 1\nother: *base\n",
+      "a: |\n  block\n  text\n",
+      "a: multi\n  line\n",
+      "a: 'it''s'\nb: \"esc\\n\"\n",
+      "--- \na: 1\n...\n",
+      "a: !!str 1\n",
+      "a:\tb\n",
+      "a: 1\r\nb: 2\r\n",
+      "scalar document\n",
+      "'quoted key': 1\n",
+      "? complex\n: value\n",
+    };
+
+    for (const char* input : inputs) {
+      CAPTURE(input);
+      YAML::Doc fast = YAML::Doc::parseString(input);
+      YAML::Doc slow = YAML::Doc::parseString(input, libyaml);
+      checkSameTree(fast, slow);
+    }
+
+    // wide mappings get their index either way
+    std::string wide;
+    for (int i = 0; i < 100; i++) {
+      wide += "key" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+    }
+    YAML::Doc doc = YAML::Doc::parseString(wide);
+    CHECK(doc.getValue<int>("key99") == 99);
+
+    // errors are reported by libyaml
+    const char* invalid[] = {
+      "a: b: c\n",  "a: 1\n  b: 2\n", "a:\n  b: 1\n c: 2\n",
+      "- a\nb: 1\n", "a: 'open\n",    "a: \x01\n",
+      "a: \xC3\n",
+    };
+    for (const char* input : invalid) {
+      CAPTURE(input);
+      CHECK_THROWS_AS(YAML::Doc::parseString(input), YAML::DocParserException);
+    }
+  }
+
+  TEST_CASE("Parsing every document of a stream")
+  {
+    std::vector<YAML::Doc> docs = YAML::Doc::parseAllString(
+      "# header\nname: first\n---\nname: second\n--- [1, 2]\n---\n"
+      "- a\n...\n---\n");
+    REQUIRE(docs.size() == 5);
+    CHECK(docs[0].getValue("name") == "first");
+    CHECK(docs[1].getValue("name") == "second");
+    CHECK(docs[2].getValue<int>("1") == 2);
+    CHECK(docs[3].getValue("0") == "a");
+    CHECK(docs[4].getType() == YAML::Doc::SCALAR);
+    CHECK(YAML::Doc::parseAllString("# nothing\n").empty());
+
+    // large streams are split between threads, documents keep their order
+    std::string stream;
+    for (int i = 0; i < 20000; i++) {
+      stream += "---\nid: " + std::to_string(i) +
+                "\nitems:\n  - {name: flow, count: 1}\n  - plain\n";
+    }
+    REQUIRE(stream.size() > YAML::ParseOptions::PARALLEL_THRESHOLD);
+
+    YAML::ParseOptions parallel;
+    parallel.threads = 4;
+    YAML::ParseOptions serial;
+    serial.threads = 1;
+    serial.fastScan = false;
+
+    std::vector<YAML::Doc> fast = YAML::Doc::parseAllString(stream, parallel);
+    std::vector<YAML::Doc> slow = YAML::Doc::parseAllString(stream, serial);
+    REQUIRE(fast.size() == 20000);
+    REQUIRE(slow.size() == 20000);
+    for (size_t i = 0; i < fast.size(); i += 97) {
+      checkSameTree(fast[i], slow[i]);
+    }
+    CHECK(fast[12345].getValue<int>("id") == 12345);
+    CHECK(fast[12345].getValue("items.0.name") == "flow");
+
+    // the first error in stream order is reported
+    std::string broken = stream + "---\nbad: [\n" + stream;
+    CHECK_THROWS_AS(YAML::Doc::parseAllString(broken, parallel),
+                    YAML::DocParserException);
+  }
+
+  TEST_CASE("Parsing input pulled from a reader")
+  {
+    std::istringstream input("a: [1, {b: 'x'}]\nc: [[2]]\n");
+    EventRecorder recorder;
+    YAML::Doc::parseInput(input, recorder);
+    EventRecorder expected;
+    YAML::Doc::parseString("a: [1, {b: 'x'}]\nc: [[2]]\n", expected);
+    CHECK(recorder.events == expected.events);
+
+    // documents are generated as they're read and dropped once handled
+    const int documents = 5000;
+    int generated = 0;
+    std::string pending;
+    size_t offset = 0;
+    YAML::Doc::Reader generator = [&](char* pBuffer, size_t pSize) {
+      if (offset == pending.size() && generated < documents) {
+        pending = "---\nid: " + std::to_string(generated) + "\nname: 'doc " +
+                  std::to_string(generated) + "'\n";
+        generated++;
+        offset = 0;
+      }
+      // a few bytes at a time, like a slow pipe
+      size_t size = std::min<size_t>({ pSize, pending.size() - offset, 7 });
+      std::memcpy(pBuffer, pending.data() + offset, size);
+      offset += size;
+      return size;
+    };
+
+    int received = 0;
+    int64_t ids = 0;
+    YAML::Doc last;
+    YAML::Doc::parseAllInput(generator, [&](YAML::Doc&& pDoc) {
+      ids += pDoc.getValue<int>("id");
+      received++;
+      last = std::move(pDoc);
+    });
+    CHECK(received == documents);
+    CHECK(ids == int64_t(documents) * (documents - 1) / 2);
+    CHECK(last.getValue("name") == "doc 4999");
+
+    std::istringstream stream("first: 1\n---\n- second\n");
+    char buffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource pool(buffer, sizeof(buffer));
+    std::vector<YAML::Doc> docs;
+    YAML::ParseOptions options;
+    options.memory = &pool;
+    YAML::Doc::parseAllInput(
+      stream,
+      [&](YAML::Doc&& pDoc) { docs.push_back(std::move(pDoc)); },
+      options);
+    REQUIRE(docs.size() == 2);
+    CHECK(docs[0].getValue<int>("first") == 1);
+    CHECK(docs[1].getValue("0") == "second");
+    CHECK(docs[1].getMemoryResource() == &pool);
+
+    // what the reader throws comes out of the parse
+    struct Disconnected
+    {
+    };
+    YAML::Doc::Reader failing = [](char*, size_t) -> size_t {
+      throw Disconnected();
+    };
+    CHECK_THROWS_AS(YAML::Doc::parseInput(failing, recorder), Disconnected);
+    std::istringstream broken("a: [1\n");
+    CHECK_THROWS_AS(
+      YAML::Doc::parseAllInput(broken, [](YAML::Doc&&) {}),
+      YAML::DocParserException);
+  }
+
+  TEST_CASE("Anchors, aliases and merge keys")
+  {
+    YAML::Doc doc = YAML::Doc::parseString(
+      "defaults: &defaults\n  adapter: postgres\n  host: localhost\n"
+      "  pool: 5\n"
+      "development:\n  <<: *defaults\n  database: dev\n  pool: 10\n"
+      "shared: *defaults\n"
+      "name: &name widget\nlabel: *name\n"
+      "ports:\n  - &http {port: 80}\n  - *http\n"
+      "both:\n  <<: [*http, {port: 443, tls: true}]\n");
+
+    YAML::Doc* defaults = doc.getNode("defaults");
+    YAML::Doc* shared = doc.getNode("shared");
+    CHECK(shared->isAlias());
+    CHECK(shared->getChildCount() == 3);
+    CHECK(shared->getFirstChild() == defaults->getFirstChild());
+    CHECK(doc.getValue("shared.host") == "localhost");
+    CHECK(doc.getValue("label") == "widget");
+    CHECK(doc.getValue<int>("ports.1.port") == 80);
+    CHECK(std::string(doc.getNode("ports.1")->getValueOr("none")) == "none");
+
+    // explicit keys win over merged ones, and earlier sources over later ones
+    YAML::Doc* development = doc.getNode("development");
+    CHECK(development->getChildCount() == 4);
+    CHECK(doc.getValue<int>("development.pool") == 10);
+    CHECK(doc.getValue("development.adapter") == "postgres");
+    CHECK(doc.getNode("development.host")->getFirstChild() == nullptr);
+    YAML::Doc* missing;
+    CHECK_FALSE(doc.tryGetNode("development.<<", missing));
+    CHECK(doc.getValue<int>("both.port") == 80);
+    CHECK(doc.getValue<bool>("both.tls"));
+
+    // traversals walk shared subtrees only where they are anchored
+    size_t visited = 0;
+    for ([[maybe_unused]] YAML::Doc& node : doc.depthFirst()) {
+      visited++;
+    }
+    size_t breadth = 0;
+    for ([[maybe_unused]] YAML::Doc& node : doc.breadthFirst()) {
+      breadth++;
+    }
+    CHECK(visited == breadth);
+    CHECK(visited == 19);
+
+    // copies expand aliases, and changing an alias unshares it first
+    YAML::Doc copy = *shared;
+    CHECK_FALSE(copy.isAlias());
+    CHECK(copy.getValue("adapter") == "postgres");
+    shared->createChild();
+    CHECK_FALSE(shared->isAlias());
+    CHECK(shared->getChildCount() == 4);
+    CHECK(defaults->getChildCount() == 3);
+
+    CHECK_THROWS_AS(YAML::Doc::parseString("a: *missing\n"),
+                    YAML::DocParserException);
+    CHECK_THROWS_AS(YAML::Doc::parseString("a: &a [*a]\n"),
+                    YAML::DocParserException);
+    CHECK_THROWS_AS(YAML::Doc::parseString("a: &a 1\nb:\n  <<: *a\n"),
+                    YAML::DocParserException);
+
+    // only a plain << merges, quoted ones are string keys
+    YAML::Doc quoted = YAML::Doc::parseString(
+      "base: &base {a: 1}\nx: {\"<<\": *base, b: 2}\n"
+      "y:\n  '<<': 3\n  <<: *base\n");
+    CHECK(quoted.getNode("x")->getChildCount() == 2);
+    CHECK(quoted.getNode("x.<<")->isAlias());
+    CHECK_FALSE(quoted.tryGetNode("x.a", missing));
+    CHECK(quoted.getNode("y")->getChildCount() == 2);
+    CHECK(quoted.getValue<int>("y.<<") == 3);
+    CHECK(quoted.getValue<int>("y.a") == 1);
+    YAML::Doc rewritten = YAML::Doc::parseString(quoted.toYaml());
+    CHECK(rewritten.getValue<int>("y.<<") == 3);
+
+    // anchors outside of a selection are still there for the aliases in it
+    YAML::Doc selected = YAML::Doc::parseString(
+      "base: &base {retries: 3}\njobs:\n  build:\n    <<: *base\n",
+      YAML::Selection{ "jobs" });
+    CHECK(selected.getValue<int>("jobs.build.retries") == 3);
+    CHECK_FALSE(selected.tryGetNode("base", missing));
+
+    // billion laughs: a thousand million nodes once expanded
+    std::string laughs = "l0: &l0 [lol, lol, lol, lol, lol, lol, lol, lol]\n";
+    for (int i = 1; i < 10; i++) {
+      std::string previous = "*l" + std::to_string(i - 1);
+      laughs += "l" + std::to_string(i) + ": &l" + std::to_string(i) + " [";
+      for (int j = 0; j < 8; j++) {
+        laughs += (j ? ", " : "") + previous;
+      }
+      laughs += "]\n";
+    }
+    YAML::Doc bomb = YAML::Doc::parseString(laughs);
+    CHECK(bomb.getValue("l9.7.7.7.7.7.7.7.7.7.7") == "lol");
+    CHECK_THROWS_AS(bomb.toString(), YAML::DocNodeException);
+    CHECK_THROWS_AS(YAML::Doc(*bomb.getNode("l9")), YAML::DocNodeException);
+
+    // moves that have to copy keep the aliases shared instead
+    static_assert(std::is_nothrow_move_constructible_v<YAML::Doc>);
+    YAML::Doc moved = std::move(*bomb.getNode("l9"));
+    CHECK(moved.getNode("0")->isAlias());
+    CHECK(moved.getNode("0")->getFirstChild() ==
+          moved.getNode("7")->getFirstChild());
+    CHECK(moved.getValue("7.6.5.4.3.2.1.0.7.1") == "lol");
+    CHECK(bomb.getValue("l9.0.1.2.3.4.5.6.7.0.1") == "lol");
+
+    std::pmr::unsynchronized_pool_resource pool;
+    YAML::Doc other(&pool);
+    other = std::move(bomb);
+    CHECK(other.getMemoryResource() == &pool);
+    CHECK(other.getNode("l3.2")->isAlias());
+    CHECK(other.getNode("l3.2")->getFirstChild() ==
+          other.getNode("l2")->getFirstChild());
+    CHECK(other.getValue("l9.1.2.3.4.5.6.7.0.1.2") == "lol");
+  }
+
+  TEST_CASE("Binary snapshots")
+  {
+    namespace fs = std::filesystem;
+    fs::path directory = fs::temp_directory_path() / "yaml-doc-snapshots";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+
+    std::string yaml = "flags:\n";
+    for (int i = 0; i < 100; i++) {
+      yaml += "  flag" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+    }
+    yaml += "base: &base {a: 1}\nmerged:\n  <<: *base\n  b: \"two\"\n"
+            "real: 2.5\n";
+    YAML::Doc doc = YAML::Doc::parseString(yaml);
+
+    std::string path = (directory / "doc.ydoc").string();
+    doc.saveSnapshot(path);
+    YAML::Doc loaded = YAML::Doc::loadSnapshot(path);
+    checkSameTree(doc, loaded);
+    CHECK(loaded.getValue<int>("flags.flag42") == 42);
+    CHECK(loaded.getValue<double>("real") == 2.5);
+    CHECK(loaded.getNode("merged.a")->isAlias());
+    CHECK(loaded.getNode("merged.b")->getScalarKind() == YAML::Scalar::STRING);
+    CHECK(std::string(loaded.getNode("merged.b")->getValueOr("")) == "two");
+
+    // a subtree is saved as a document of its own
+    doc.getNode("merged")->saveSnapshot(path);
+    YAML::Doc merged = YAML::Doc::loadSnapshot(path);
+    CHECK(merged.getChildCount() == 2);
+    CHECK(merged.getValue<int>("a") == 1);
+
+    // damaged files are rejected
+    std::string bytes;
+    {
+      std::ifstream in(path, std::ios::binary);
+      bytes.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    for (size_t cut : { size_t(0), size_t(20), bytes.size() - 1 }) {
+      std::ofstream(path, std::ios::binary).write(bytes.data(), cut);
+      CHECK_THROWS_AS(YAML::Doc::loadSnapshot(path), YAML::DocFileException);
+    }
+    // links between records that disagree: a count too large, a wrong last
+    // child, a child hanging from another node
+    auto damage = [&](size_t pRecord, size_t pField, uint32_t pValue) {
+      std::string damaged = bytes;
+      std::memcpy(&damaged[64 + 64 * pRecord + pField], &pValue, 4);
+      std::ofstream(path, std::ios::binary)
+        .write(damaged.data(), damaged.size());
+    };
+    uint32_t first;
+    std::memcpy(&first, &bytes[64 + 28], 4);
+    damage(0, 40, 0x7FFFFFFF);
+    CHECK_THROWS_AS(YAML::Doc::loadSnapshot(path), YAML::DocFileException);
+    damage(0, 32, first);
+    CHECK_THROWS_AS(YAML::Doc::loadSnapshot(path), YAML::DocFileException);
+    damage(first + 1, 24, UINT32_MAX);
+    CHECK_THROWS_AS(YAML::Doc::loadSnapshot(path), YAML::DocFileException);
+
+    bytes[64 + 64 + 12] = 0x7F;
+    std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size());
+    CHECK_THROWS_AS(YAML::Doc::loadSnapshot(path), YAML::DocFileException);
+
+    // parseFile() reuses the snapshot while the source keeps its size and
+    // modification time
+    std::string source = (directory / "config.yaml").string();
+    std::ofstream(source) << "name: first\n";
+    YAML::ParseOptions options;
+    options.snapshotCache = (directory / "cache").string();
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "first");
+    CHECK(std::distance(fs::directory_iterator(options.snapshotCache),
+                        fs::directory_iterator()) == 1);
+
+    fs::file_time_type time = fs::last_write_time(source);
+    std::ofstream(source) << "name: other\n";
+    fs::last_write_time(source, time);
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "first");
+
+    std::ofstream(source) << "name: changed\n";
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "changed");
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "changed");
+
+    // a damaged snapshot is made again
+    for (const fs::directory_entry& entry :
+         fs::directory_iterator(options.snapshotCache)) {
+      std::fstream cached(entry.path(),
+                          std::ios::binary | std::ios::in | std::ios::out);
+      cached.seekp(64 + 40);
+      cached.write("\xff\xff\xff\x7f", 4);
+    }
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "changed");
+    CHECK(YAML::Doc::parseFile(source, options).getValue("name") == "changed");
+
+    fs::remove_all(directory);
+  }
+
+  TEST_CASE("Decoding structs declared with YAML_DOC_FIELDS")
+  {
+    YAML::Doc doc = YAML::Doc::parseString(
+      "name: Average Person\nunknown: ignored\nlevel: 3\nhero: true\n"
+      "tags: [tall, brave]\n"
+      "inventory:\n  - item: banana\n    quantity: 2\n  - damage: 5\n");
+
+    Character character = doc.getValue<Character>();
+    CHECK(character.name == "Average Person");
+    CHECK(character.level == 3);
+    CHECK(character.speed == 1.0);
+    CHECK(character.hero);
+    REQUIRE(character.tags.size() == 2);
+    CHECK(character.tags[1] == "brave");
+    REQUIRE(character.inventory.size() == 2);
+    CHECK(character.inventory[0].item == "banana");
+    CHECK(character.inventory[0].quantity == 2);
+    CHECK(character.inventory[1].item == "unknown");
+    CHECK(character.inventory[1].damage == 5);
+
+    // merged keys are decoded like the others
+    YAML::Doc merged = YAML::Doc::parseString(
+      "base: &base {quantity: 4, damage: 1}\n"
+      "sword:\n  <<: *base\n  item: sword\n  damage: 7\n");
+    InventoryItem sword = merged.getValue<InventoryItem>("sword");
+    CHECK(sword.item == "sword");
+    CHECK(sword.quantity == 4);
+    CHECK(sword.damage == 7);
+
+    YAML::Doc wrong = YAML::Doc::parseString("name: x\nlevel: high\n");
+    CHECK_THROWS_AS(wrong.getValue<Character>(),
+                    YAML::DocConversionException);
+  }
+
+  TEST_CASE("Looking up values without exceptions")
+  {
+    YAML::Doc doc = YAML::Doc::parseString(
+      "port: 8080\nname: edge\nlevel: high\nlimits: {cpu: 2}\n"
+      "tags: [a, b]\nitem: {item: axe, damage: 3}\n");
+    const YAML::Doc& constant = doc;
+
+    YAML::DocResult<int> port = doc.lookupValue<int>("port");
+    REQUIRE(port);
+    CHECK(*port == 8080);
+    CHECK(constant.lookupValue<int>(YAML::Path("port")).getValueOr(0) == 8080);
+    CHECK(doc.lookupValue<std::string_view>("name").getValueOr("") == "edge");
+
+    CHECK(doc.lookupValue<int>("timeout").getError() ==
+          YAML::DocError::NOT_FOUND);
+    CHECK(constant.lookupValue<int>("port.x").getError() ==
+          YAML::DocError::NOT_FOUND);
+    CHECK(doc.lookupValue<int>("level").getError() ==
+          YAML::DocError::CONVERSION_FAILED);
+    CHECK(doc.lookupValue<uint8_t>("port").getError() ==
+          YAML::DocError::CONVERSION_FAILED);
+    CHECK(doc.lookupValue<int>("limits").getError() ==
+          YAML::DocError::TYPE_MISMATCH);
+    CHECK(doc.lookupValue<std::string>("tags").getError() ==
+          YAML::DocError::TYPE_MISMATCH);
+    CHECK(doc.lookupValue<InventoryItem>("name").getError() ==
+          YAML::DocError::TYPE_MISMATCH);
+    CHECK(doc.lookupValue<int>("timeout").getValueOr(30) == 30);
+
+    YAML::DocResult<InventoryItem> item =
+      doc.lookupValue<InventoryItem>("item");
+    REQUIRE(item);
+    CHECK(item->item == "axe");
+    CHECK(item->damage == 3);
+    CHECK(doc.lookupValue<std::vector<std::string>>("tags")->size() == 2);
+
+    REQUIRE(doc.lookup("limits.cpu"));
+    CHECK(doc.lookup("limits.cpu").getError() == YAML::DocError::NONE);
+    CHECK((*doc.lookup("limits.cpu"))->convert<int>().getValueOr(0) == 2);
+    CHECK(constant.lookup("limits.gpu").getError() ==
+          YAML::DocError::NOT_FOUND);
+
+    // the try functions report a failed conversion instead of throwing it
+    int level = 1;
+    CHECK_FALSE(doc.tryGetValue("level", &level));
+    CHECK(level == 1);
+    CHECK_FALSE(doc.tryGetValue("level", &level, 5));
+    CHECK(level == 5);
+    CHECK_FALSE(doc.getNode("level")->tryGetValue(&level));
+    CHECK(doc.tryGetValue("port", &level));
+    CHECK(level == 8080);
+
+    // types with only a getValue<T>() specialization convert through it
+    Pickup pickup{ "none", 0 };
+    CHECK(doc.tryGetValue("item", &pickup));
+    CHECK(pickup.item == "axe");
+    CHECK(pickup.quantity == 1);
+    CHECK_FALSE(doc.tryGetValue("missing", &pickup));
+    CHECK(constant.lookupValue<Weapon>("item")->damage == 3);
+    CHECK(constant.lookupValue<Weapon>("missing").getError() ==
+          YAML::DocError::NOT_FOUND);
+
+    CHECK_THROWS_AS(doc.getValue<int>("level"), YAML::DocConversionException);
+    CHECK_THROWS_AS(doc.getValue<int>("limits"),
+                    YAML::DocConversionException);
+    CHECK_THROWS_AS(doc.getNode("timeout"), YAML::DocNodeException);
+  }
+
+  TEST_CASE("Looking up many paths in one walk")
+  {
+    std::string wide;
+    for (int i = 0; i < 40; i++) {
+      wide += "  key" + std::to_string(i) + ": " + std::to_string(i) + "\n";
+    }
+    YAML::Doc doc = YAML::Doc::parseString(
+      "server:\n  host: edge\n  port: 8080\n  tls: {cert: a.pem}\n"
+      "list: [zero, one]\nbase: &base {x: 1}\nlinked: *base\nwide:\n" +
+      wide);
+
+    YAML::PathSet paths = { "server.port", "server.host", "server.tls.cert",
+                            "server.missing", "list.1", "linked.x",
+                            "wide.key33", "nowhere.at.all" };
+    CHECK(paths.add("server.host") == 1);
+    CHECK(paths.add("") == 8);
+    CHECK(paths.size() == 9);
+    CHECK(paths.getPath(2) == "server.tls.cert");
+    CHECK(paths.segmentCount() == 18);
+    CHECK(paths.entryCount() == 15);
+
+    YAML::LookupStats stats;
+    doc.setLookupStats(&stats);
+    std::vector<YAML::Doc*> found(paths.size());
+    CHECK(doc.lookup(paths, found.data()) == 7);
+    doc.setLookupStats(nullptr);
+    CHECK(stats.hits == 7);
+    CHECK(stats.misses == 2);
+
+    CHECK(found[0] == doc.getNode("server.port"));
+    CHECK(found[1]->getValue() == "edge");
+    CHECK(found[2]->getValue() == "a.pem");
+    CHECK(found[3] == nullptr);
+    CHECK(found[4]->getValue() == "one");
+    CHECK(found[5]->getValue<int>() == 1);
+    CHECK(found[6]->getValue<int>() == 33);
+    CHECK(found[7] == nullptr);
+    CHECK(found[8] == &doc);
+
+    // from a node, and through the const walk that builds no index
+    const YAML::Doc& server = *doc.getNode("server");
+    YAML::PathSet relative = { "port", "tls.cert" };
+    std::vector<const YAML::Doc*> below(relative.size());
+    CHECK(server.lookup(relative, below.data()) == 2);
+    CHECK(below[0]->getValue<int>() == 8080);
+    YAML::Doc copy = doc;
+    const YAML::Doc& frozen = copy;
+    std::vector<const YAML::Doc*> constant(paths.size());
+    CHECK(frozen.lookup(paths, constant.data()) == 7);
+    CHECK(constant[6]->getValue<int>() == 33);
+
+    struct Settings
+    {
+      std::string host;
+      int port = 0;
+      int timeout = 30;
+    };
+    YAML::PathBinding<Settings> binding;
+    binding.bind("server.host", &Settings::host)
+      .bind("server.port", &Settings::port)
+      .bind("server.timeout", &Settings::timeout);
+    YAML::DocResult<Settings> settings = binding.decode(doc);
+    REQUIRE(settings);
+    CHECK(settings->host == "edge");
+    CHECK(settings->port == 8080);
+    CHECK(settings->timeout == 30);
+
+    YAML::PathBinding<Settings> wrong;
+    wrong.bind("server.tls", &Settings::port);
+    CHECK(wrong.decode(doc).getError() == YAML::DocError::TYPE_MISMATCH);
+  }
+
+  TEST_CASE("Extracting fields of a sequence into columns")
+  {
+    std::string yaml = "base: &base {damage: 9, item: copy}\ninventory:\n";
+    for (int i = 0; i < 600; i++) {
+      if (i == 5) {
+        yaml += "  - *base\n";
+      } else if (i == 7) {
+        yaml += "  - plain\n";
+      } else if (i % 100 == 50) {
+        yaml += "  - {item: broken, damage: high}\n";
+      } else {
+        yaml += "  - item: sword" + std::to_string(i) + "\n";
+        yaml += "    stats: {weight: " + std::to_string(i) + ".5}\n";
+        yaml += i % 7 == 0 ? "    rare: true\n" : "    rare: false\n";
+        if (i % 3 != 0) {
+          yaml += "    damage: " + std::to_string(i) + "\n";
+        }
+      }
+    }
+    YAML::Doc doc = YAML::Doc::parseString(yaml);
+
+    YAML::ColumnSet columns;
+    const YAML::Column<int>& damage = columns.add<int>("damage", -1);
+    const YAML::Column<std::string_view>& items =
+      columns.add<std::string_view>("item");
+    const YAML::Column<double>& weight = columns.add<double>("stats.weight");
+    const YAML::Column<bool>& missing = columns.add<bool>("missing", true);
+    const YAML::Column<bool>& rare = columns.add<bool>("rare");
+    columns.extract(*doc.getNode("inventory"));
+
+    REQUIRE(columns.size() == 600);
+    REQUIRE(damage.size() == 600);
+    CHECK(damage[1] == 1);
+    CHECK(damage.isValid(1));
+    CHECK(damage[3] == -1);
+    CHECK_FALSE(damage.isValid(3));
+    CHECK(damage[5] == 9);
+    CHECK(items[5] == "copy");
+    CHECK_FALSE(items.isValid(7));
+    CHECK(items[7].empty());
+    CHECK(items[50] == "broken");
+    CHECK_FALSE(damage.isValid(50));
+    CHECK(damage[50] == -1);
+    CHECK(items[599] == "sword599");
+    CHECK(weight[598] == 598.5);
+    CHECK_FALSE(weight.isValid(5));
+    CHECK(missing.countValid() == 0);
+    CHECK(missing.getValues()[0]);
+    CHECK(missing[599]);
+
+    // bools are a byte per row, contiguous like the other columns
+    CHECK(rare[14]);
+    CHECK_FALSE(rare[15]);
+    CHECK_FALSE(rare[5]);
+    CHECK_FALSE(rare.isValid(5));
+    CHECK(rare.getValues().data()[21] == 1);
+    CHECK(damage.getValidity().size() == 10);
+
+    size_t valid = 0;
+    for (size_t i = 0; i < 600; i++) {
+      valid += damage.isValid(i);
+      if (damage.isValid(i) && i != 5) {
+        CHECK(damage[i] == int(i));
+      }
+    }
+    CHECK(valid == damage.countValid());
+    // two rows in three have a damage, less the five odd rows that had one
+    CHECK(valid == 395);
+
+    // a second extract replaces the first
+    columns.extract(*doc.getNode("base"));
+    CHECK(columns.size() == 2);
+    CHECK_FALSE(damage.isValid(0));
+    columns.extract(YAML::Doc());
+    CHECK(damage.size() == 0);
+  }
+
+  TEST_CASE("Writing YAML")
+  {
+    YAML::Doc doc = YAML::Doc::parseString(
+      "plain: text\nquoted: \"123\"\nempty: \"\"\nnothing:\n"
+      "tagged: !!int 0x1F\nhash: \"a #b\"\ncolon: \"a: b\"\n"
+      "dash: \"- a\"\nlines: \"one\\ntwo\\t\\x01\\u2028\\\"\\\\\"\n"
+      "\"key: odd\": 1\nlist: [1, [2, 3], {a: 4, b: [5]}, [], {}]\n"
+      "base: &base {x: 1, y: [2]}\nmerged:\n  <<: *base\n  y: 3\n"
+      "again: *base\nitems:\n  - &item {name: a}\n  - *item\n");
+
+    YAML::Doc written = YAML::Doc::parseString(doc.toYaml());
+    checkSameTree(doc, written);
+    CHECK(written.getNode("again")->isAlias());
+    CHECK(written.getNode("items.1")->isAlias());
+    CHECK(written.getNode("merged.x")->isAlias());
+
+    // scalars at the root and deep trees
+    YAML::Doc scalar = YAML::Doc::parseString("\"true\"");
+    CHECK(scalar.toYaml() == "\"true\"\n");
+    std::string deep;
+    for (int i = 0; i < 5000; i++) {
+      deep += std::string(2 * i, ' ') + "k:\n";
+    }
+    deep += std::string(10000, ' ') + "k: v\n";
+    YAML::Doc tower = YAML::Doc::parseString(deep);
+    YAML::Doc rebuilt = YAML::Doc::parseString(tower.toYaml());
+    checkSameTree(tower, rebuilt);
+
+    // the sink gets the text in chunks of at most BUFFER_SIZE bytes, but for
+    // scalars larger than that
+    YAML::Doc flags = YAML::Doc::parseString(
+      "flags: [" + std::string(20000, 'x') + ", " + std::string(100000, 'y') +
+      "]\n");
+    std::string out;
+    size_t calls = 0;
+    {
+      YAML::DocWriter writer([&](std::string_view pText) {
+        CHECK((pText.size() <= YAML::DocWriter::BUFFER_SIZE ||
+               pText.size() == 100000));
+        out += pText;
+        calls++;
+      });
+      for (int i = 0; i < 10; i++) {
+        writer.writeYaml(flags);
+      }
+    }
+    CHECK(calls > 10);
+    CHECK(out.size() == 10 * flags.toYaml().size());
+  }
+
+  TEST_CASE("Reloading edited documents")
+  {
+    std::string yaml = "name: service\n"
+                       "limits:\n  cpu: 2\n  memory: 512\n"
+                       "servers:\n"
+                       "  - host: a\n    port: 80\n"
+                       "  - host: b\n    port: 81\n"
+                       "# end\n";
+    YAML::Doc doc = YAML::Doc::parseString(yaml);
+
+    auto edited = [&](std::string_view pFrom, std::string_view pTo) {
+      std::string text = yaml;
+      return text.replace(text.find(pFrom), pFrom.size(), pTo);
+    };
+    // the reloaded tree is the one a full parse builds
+    auto reload = [&](const std::string& pYaml) {
+      YAML::DocChanges changes;
+      YAML::Doc reloaded = YAML::Doc::reloadString(doc, pYaml, &changes);
+      YAML::Doc parsed = YAML::Doc::parseString(pYaml);
+      checkSameTree(reloaded, parsed);
+      return changes;
+    };
+    using Paths = std::vector<std::string>;
+
+    YAML::DocChanges changes = reload(edited("port: 81", "port: 8080"));
+    CHECK(changes.modified == Paths{ "servers.1.port" });
+    CHECK(changes.added.empty());
+    CHECK(changes.removed.empty());
+
+    changes = reload(edited("  - host: b", "  - host: c\n    port: 82\n"
+                                           "  - host: b"));
+    CHECK(changes.added == Paths{ "servers.1" });
+    CHECK(changes.modified.empty());
+
+    changes = reload(edited("  memory: 512\n", "  swap: 0\n"));
+    CHECK(changes.added == Paths{ "limits.swap" });
+    CHECK(changes.removed == Paths{ "limits.memory" });
+
+    changes = reload(edited("name: service", "name: [a, b]"));
+    CHECK(changes.modified == Paths{ "name" });
+
+    changes = reload(edited("# end\n", "# end\nextra:\n  - 1\n"));
+    CHECK(changes.added == Paths{ "extra" });
+
+    CHECK(reload(yaml).empty());
+    CHECK(reload("---\n" + yaml).empty());
+
+    // edits that can't be isolated, and trees modified after parsing, are
+    // parsed whole
+    changes = reload(edited("limits:", "limits: &limits") + "copy: *limits\n");
+    CHECK(changes.added == Paths{ "copy" });
+    changes = reload(edited("  cpu: 2\n  memory: 512\n", "  {cpu: 4}\n"));
+    CHECK(changes.modified == Paths{ "limits.cpu" });
+    CHECK(changes.removed == Paths{ "limits.memory" });
+    YAML::Doc modified = YAML::Doc::parseString(yaml);
+    modified.getNode("limits")->createChild();
+    YAML::Doc reloaded = YAML::Doc::reloadString(modified, yaml);
+    CHECK(reloaded.getNode("limits")->getChildCount() == 2);
+
+    CHECK_THROWS_AS(YAML::Doc::reloadString(doc, edited("cpu: 2", "cpu: [2")),
+                    YAML::DocParserException);
+    // nor what is only valid apart from the rest of the input
+    auto rejected = [](const std::string& pBefore, const std::string& pAfter) {
+      YAML::Doc before = YAML::Doc::parseString(pBefore);
+      CHECK_THROWS_AS(YAML::Doc::parseString(pAfter), YAML::DocParserException);
+      CHECK_THROWS_AS(YAML::Doc::reloadString(before, pAfter),
+                      YAML::DocParserException);
+    };
+    rejected("c: {a: 1}\ne: x\n", "--- {a: 1}\ne: x\n");
+    rejected("d:\n  b: ~\nf: ~\n", "&a\n d:\n  b: ~\nf: ~\n");
+    rejected(yaml, edited("  cpu: 2\n", "  {cpu: 2}\n"));
+    rejected(yaml, edited("  memory: 512\n", "  &m\n  memory: 512\n"));
+    rejected("a: 1\n'r': 2\n", "a: 1\n''\n");
+
+    // the reloaded document doesn't depend on the previous one
+    {
+      YAML::Doc first = YAML::Doc::parseString(yaml);
+      reloaded = YAML::Doc::reloadString(first, edited("cpu: 2", "cpu: 3"));
+    }
+    CHECK(reloaded.getValue<int>("limits.cpu") == 3);
+    CHECK(reloaded.getValue("servers.0.host") == "a");
+    CHECK(doc.getValue<int>("limits.cpu") == 2);
+
+    namespace fs = std::filesystem;
+    std::string path =
+      (fs::temp_directory_path() / "yaml-doc-reload.yaml").string();
+    std::ofstream(path) << yaml;
+    YAML::Doc file = YAML::Doc::parseFile(path);
+    // rewritten in place, the document kept a copy of the file
+    std::ofstream(path) << edited("host: a", "host: z");
+    CHECK(file.getValue("servers.0.host") == "a");
+    changes.clear();
+    file = YAML::Doc::reloadFile(file, path, &changes);
+    CHECK(changes.modified == Paths{ "servers.0.host" });
+    CHECK(file.getValue("servers.0.host") == "z");
+
+    // a mapped file is replaced rather than rewritten
+    YAML::ParseOptions options;
+    options.mapFile = true;
+    YAML::Doc mapped = YAML::Doc::parseFile(path, options);
+    std::ofstream(path + ".new") << edited("host: a", "host: y");
+    fs::rename(path + ".new", path);
+    CHECK(mapped.getValue("servers.0.host") == "z");
+    changes.clear();
+    mapped = YAML::Doc::reloadFile(mapped, path, &changes);
+    CHECK(changes.modified == Paths{ "servers.0.host" });
+    CHECK(mapped.getValue("servers.0.host") == "y");
+    fs::remove(path);
+
+    // keys repeated from entry to entry, sequences at the column of theirs
+    yaml = "a:\n  tags:\n  - x\n  id: 1\nb:\n  tags:\n  - y\n  id: 2\n"
+           "items:\n- name: c\n  id: 3\n- name: d\n  id: 4\n";
+    doc = YAML::Doc::parseString(yaml);
+    CHECK(reload(edited("id: 2", "id: 5")).modified == Paths{ "b.id" });
+    CHECK(reload(edited("- y", "- z")).modified == Paths{ "b.tags.0" });
+    CHECK(reload(edited("id: 4", "id: 6")).modified == Paths{ "items.1.id" });
+  }
+
+  TEST_CASE("Parse statistics and lookup counters")
+  {
+    std::string yaml = "server:\n  host: example.com\n  port: 80\n"
+                       "tags:\n  - a\n  - b\n  - c\n";
+    YAML::ParseStats stats;
+    YAML::ParseOptions options;
+    options.stats = &stats;
+    YAML::Doc doc = YAML::Doc::parseString(yaml, options);
+    CHECK(stats.bytes == yaml.size());
+    CHECK(stats.fastScanned);
+    CHECK(stats.events == 0);
+    CHECK(stats.nodesByType[YAML::Doc::MAPPING] == 2);
+    CHECK(stats.nodesByType[YAML::Doc::SEQUENCE] == 1);
+    CHECK(stats.nodesByType[YAML::Doc::SCALAR] == 5);
+    CHECK(stats.maxDepth == 2);
+    CHECK(stats.widestMapping == 2);
+    CHECK(stats.keyBytes == 21);
+    CHECK(stats.valueBytes == 16);
+    CHECK(stats.allocations > 0);
+
+    // libyaml builds the documents the block scanner gives up on
+    YAML::Doc aliased = YAML::Doc::parseString(
+      "base: &base {a: 1}\ncopy: *base\n", options);
+    CHECK_FALSE(stats.fastScanned);
+    CHECK(stats.events > 0);
+    CHECK(stats.aliases == 1);
+    CHECK(stats.eventSeconds > 0);
+
+    YAML::LookupStats lookups;
+    doc.setLookupStats(&lookups);
+    doc.getNode("server.port");
+    CHECK(doc.getValue("server.missing.deeper", "none") == "none");
+    static constexpr YAML::Path tag("tags.1");
+    CHECK(std::as_const(doc).getValue(tag) == "b");
+    CHECK(lookups.hits == 2);
+    CHECK(lookups.misses == 1);
+    CHECK(lookups.segments == 7);
+    CHECK(lookups.segmentsCompared == 6);
+    CHECK(lookups.averageDepth() == doctest::Approx(7.0 / 3));
+
+    doc.setLookupStats(nullptr);
+    doc.getNode("server");
+    CHECK(lookups.hits == 2);
+  }
+
+  TEST_CASE("Names are interned once per document")
+  {
+    std::string yaml;
+    for (int i = 0; i < 50; i++) {
+      yaml += "- item: sword\n  quantity: " + std::to_string(i) + "\n";
+    }
+    YAML::ParseStats stats;
+    YAML::ParseOptions options;
+    options.stats = &stats;
+    YAML::Doc doc = YAML::Doc::parseString(yaml, options);
+    // the empty name, root, item, quantity and 0 to 49
+    CHECK(stats.keys == 54);
+    CHECK(doc.getNode("3.item")->getNameView().data() ==
+          doc.getNode("42.item")->getNameView().data());
+    CHECK(doc.getValue<int>("42.quantity") == 42);
+    YAML::Doc* missing;
+    CHECK_FALSE(doc.tryGetNode("42.damage", missing));
+
+    YAML::Doc built;
+    YAML::Doc* first = built.addSequenceItem()->addSequenceItem();
+    YAML::Doc* second = built.addSequenceItem()->addSequenceItem();
+    CHECK(first->getNameView() == "0");
+    CHECK(first->getNameView().data() == second->getNameView().data());
+    CHECK(built.getNode("1.0") == second);
+
+    // copied to another document, names are interned there
+    YAML::Doc copy;
+    copy.addChild(*doc.getNode("7"));
+    CHECK(copy.getValue<int>("7.quantity") == 7);
+    CHECK(copy.getNode("7.quantity")->getNameView() == "quantity");
+  }
+
+  TEST_CASE("Allocating documents from a memory resource")
+  {
+    std::vector<char> buffer(1 << 16);
+    std::pmr::monotonic_buffer_resource pool(
+      buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    // anything still going to the default resource throws
+    std::pmr::memory_resource* previous =
+      std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    std::string yaml = "name: \"escaped\\tname\"\nports:\n";
+    for (int i = 0; i < 40; i++) {
+      yaml += "  - " + std::to_string(i) + "\n";
+    }
+    YAML::Doc doc = YAML::Doc::parseString(yaml, &pool);
+    CHECK(doc.getMemoryResource() == &pool);
+    CHECK(doc.getValue("name") == "escaped\tname");
+    CHECK(doc.getValue<int>("ports.39") == 39);
+
+    YAML::Doc ports(*doc.getNode("ports"));
+    CHECK(ports.getMemoryResource() == &pool);
+    YAML::Doc moved(std::move(doc));
+    CHECK(moved.getMemoryResource() == &pool);
+    moved.getNode("ports")->addSequenceItem();
+    CHECK(moved.getNode("ports")->getChildCount() == 41);
+    CHECK(ports.getChildCount() == 40);
+
+    std::pmr::set_default_resource(previous);
+    YAML::Doc assigned = YAML::Doc::parseString("a: 1\n");
+    assigned = moved;
+    CHECK(assigned.getMemoryResource() == previous);
+    CHECK(assigned.getValue<int>("ports.7") == 7);
+    YAML::Doc target(&pool);
+    target = YAML::Doc::parseString("b: 2\n");
+    CHECK(target.getMemoryResource() == &pool);
+    CHECK(target.getValue<int>("b") == 2);
+  }
+
+  TEST_CASE("Sharing frozen documents between threads")
+  {
+    // built rather than parsed, its wide nodes aren't indexed yet
+    YAML::Doc built;
+    for (int i = 0; i < 40; i++) {
+      YAML::Doc* item = built.addSequenceItem();
+      for (int j = 0; j < i % 4; j++) {
+        item->addSequenceItem();
+      }
+    }
+    YAML::FrozenDoc frozen(std::move(built));
+    const YAML::Doc& doc = frozen.get();
+    CHECK(doc.getNode("39")->getChildCount() == 3);
+    CHECK(doc.getNode(YAML::Path("38.1"))->getNameView() == "1");
+    CHECK(doc.getValue("40.0", "none") == "none");
+    CHECK(doc.getValue<int>("41", -1) == -1);
+    const YAML::Doc* node;
+    CHECK_FALSE(doc.tryGetNode("4.0", node));
+    CHECK_THROWS_AS(doc.getNode("41"), YAML::DocNodeException);
+
+    // navigating never hands out a mutable node
+    static_assert(
+      std::is_same_v<decltype(doc.getFirstChild()), const YAML::Doc*> &&
+      std::is_same_v<decltype(doc.getNextSibling()), const YAML::Doc*> &&
+      std::is_same_v<decltype(doc.getParent()), const YAML::Doc*>);
+    CHECK(doc.getFirstChild()->getNextSibling()->getParent() == &doc);
+
+    YAML::DocHolder holder(YAML::Doc::parseString("version: 0\n"));
+    std::weak_ptr<const YAML::FrozenDoc> first = holder.get();
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    std::atomic<int> regressions = 0;
+    for (int i = 0; i < 4; i++) {
+      readers.emplace_back([&] {
+        YAML::DocHolder::Reader reader(holder);
+        int last = 0;
+        while (!done) {
+          int version = reader.get().getValue<int>("version");
+          if (version < last) {
+            regressions++;
+          }
+          last = version;
+        }
+      });
+    }
+    for (int i = 1; i <= 200; i++) {
+      holder.publish(
+        YAML::Doc::parseString("version: " + std::to_string(i) + "\n"));
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+      reader.join();
+    }
+
+    CHECK(regressions == 0);
+    CHECK(holder.getVersion() == 200);
+    CHECK(holder.get()->get().getValue<int>("version") == 200);
+    // released once no reader holds it anymore
+    CHECK(first.expired());
+  }
 }